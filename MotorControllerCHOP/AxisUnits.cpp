@@ -0,0 +1,28 @@
+#include "AxisUnits.h"
+
+#include <cmath>
+
+AxisUnits makeAxisUnits(uint32_t countsPerRev, const NodeProfile& profile)
+{
+	AxisUnits units;
+
+	// With a lead the scale follows from the mechanics, without one the profile gives it directly
+	double countsPerUnit = profile.CountsPerUnit;
+
+	if (profile.UnitsPerRev > 0.0 && countsPerRev > 0)
+	{
+		double gearRatio = profile.GearRatio > 0.0 ? profile.GearRatio : 1.0;
+		countsPerUnit = countsPerRev * gearRatio / profile.UnitsPerRev;
+	}
+
+	if (!(countsPerUnit > 0.0) || !std::isfinite(countsPerUnit))
+		countsPerUnit = 1.0;
+
+	if (profile.Direction < 0)
+		countsPerUnit = -countsPerUnit;
+
+	units.CountsPerUnit = countsPerUnit;
+	units.UnitsPerCount = 1.0 / countsPerUnit;
+
+	return units;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "NodeProfiles.h"
+
+#include <cstdint>
+
+// Position units of one axis, from the drive's counts per revolution and the profile's gearing,
+// lead and direction. Worked out once per topology change, both the commands going to the drive
+// and the telemetry coming back are converted with the same factors. Only whole targets are rounded
+// to counts, never steps between them, so a long run of moves cannot drift by the rounding.
+struct AxisUnits
+{
+	double	CountsPerUnit	= 1.0;			// Negative when the axis runs reversed
+	double	UnitsPerCount	= 1.0;
+
+	double	toCounts(double units) const { return units * CountsPerUnit; }
+	double	toUnits(double counts) const { return counts * UnitsPerCount; }
+};
+
+AxisUnits makeAxisUnits(uint32_t countsPerRev, const NodeProfile& profile);
@@ -0,0 +1,72 @@
+#include "CommandFilter.h"
+
+#include <cmath>
+
+static inline double smoothingFactor(double cutoffHz, double dtSec)
+{
+	double tau = 1.0 / (2.0 * 3.14159265358979323846 * cutoffHz);
+	return 1.0 / (1.0 + tau / dtSec);
+}
+
+CommandFilter::CommandFilter(size_t maxAxes) :
+	_pos(maxAxes, 0.0), _speed(maxAxes, 0.0), _slewed(maxAxes, 0.0), _held(maxAxes, 0.0), _primed(maxAxes, 0)
+{
+}
+
+void CommandFilter::reset(size_t axis)
+{
+	if (axis < _primed.size())
+		_primed[axis] = 0;
+}
+
+void CommandFilter::run(size_t count, const double* rawCnts, const double* countsPerUnit, const uint8_t* active,
+	double dtMsec, const CommandFilterSettings& settings, double* outCnts)
+{
+	if (count > _primed.size())
+		count = _primed.size();
+
+	// A first cook or a stall has no usable interval, the input then passes straight through
+	double dtSec = dtMsec > 0.0 ? dtMsec / 1000.0 : 0.0;
+	double filtering = settings.Mode != FILTER_OFF && dtSec > 0.0 ? 1.0 : 0.0;
+	double beta = settings.Mode == FILTER_ONE_EURO ? settings.Beta : 0.0;
+	double minCutoff = settings.MinCutoffHz > 1.0e-3 ? settings.MinCutoffHz : 1.0e-3;
+	double speedAlpha = dtSec > 0.0 ? smoothingFactor(FILTER_DERIVATIVE_CUTOFF_HZ, dtSec) : 1.0;
+	double slewing = settings.SlewUnitsPerSec > 0.0 && dtSec > 0.0 ? 1.0 : 0.0;
+
+	// Every axis goes through the same arithmetic, the settings only change the coefficients
+	for (size_t i = 0; i < count; i++)
+	{
+		double raw = rawCnts[i];
+		double scale = std::fabs(countsPerUnit[i]);	// Negative on a reversed axis
+		double primed = _primed[i] ? 1.0 : 0.0;
+		double keep = filtering * primed;
+
+		double speed = dtSec > 0.0 ? (raw - _pos[i]) / dtSec : 0.0;
+		speed = _speed[i] + speedAlpha * (speed - _speed[i]);
+
+		double cutoff = minCutoff + beta * std::fabs(speed) / scale;
+		double alpha = dtSec > 0.0 ? smoothingFactor(cutoff, dtSec) : 1.0;
+
+		double pos = _pos[i] + alpha * (raw - _pos[i]);
+		pos = keep * pos + (1.0 - keep) * raw;
+
+		double maxStep = settings.SlewUnitsPerSec * scale * dtSec;
+		double step = pos - _slewed[i];
+		step = step > maxStep ? maxStep : (step < -maxStep ? -maxStep : step);
+
+		double slewed = slewing * primed > 0.0 ? _slewed[i] + step : pos;
+
+		double threshold = 0.5 + settings.HysteresisUnits * scale;
+		double held = std::fabs(slewed - _held[i]) > threshold || primed == 0.0 ? std::round(slewed) : _held[i];
+
+		double use = active[i] ? 1.0 : 0.0;
+
+		_pos[i] = use * pos + (1.0 - use) * _pos[i];
+		_speed[i] = use * keep * speed + (1.0 - use) * _speed[i];
+		_slewed[i] = use * slewed + (1.0 - use) * _slewed[i];
+		_held[i] = use * held + (1.0 - use) * _held[i];
+		_primed[i] = (uint8_t)(_primed[i] | active[i]);
+
+		outCnts[i] = _held[i];
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FILTER_DERIVATIVE_CUTOFF_HZ		1.0		// Smoothing of the speed estimate that steers the one-euro cutoff
+
+// Smoothing applied to the position input before it becomes a target
+enum FilterMode
+{
+	FILTER_OFF = 0,
+	FILTER_LOW_PASS,		// First order, fixed cutoff
+	FILTER_ONE_EURO,		// Cutoff rises with speed: steady inputs are smoothed hard, fast ones lag little
+	FILTER_MODE_COUNT
+};
+
+struct CommandFilterSettings
+{
+	FilterMode	Mode				= FILTER_OFF;
+	double		MinCutoffHz			= 1.0;
+	double		Beta				= 0.0;		// One-euro cutoff increase per input unit per second
+	double		SlewUnitsPerSec		= 0.0;		// 0 leaves the rate of change unlimited
+	double		HysteresisUnits		= 0.0;		// Extra travel before the held target follows, on top of half a count
+};
+
+// Per-axis filter state, stored flat so one pass over all axes vectorizes. Positions are in counts;
+// the output is always a whole count, so sub-count jitter never reaches the change detection.
+class CommandFilter
+{
+private:
+	std::vector<double> _pos;			// Filtered position
+	std::vector<double> _speed;			// Filtered rate of change, counts per second
+	std::vector<double> _slewed;
+	std::vector<double> _held;
+	std::vector<uint8_t> _primed;
+
+public:
+	explicit CommandFilter(size_t maxAxes);
+
+	void reset(size_t axis);
+
+	// active[i] == 0 leaves axis i untouched; outCnts receives the held target of every active axis
+	void run(size_t count, const double* rawCnts, const double* countsPerUnit, const uint8_t* active,
+		double dtMsec, const CommandFilterSettings& settings, double* outCnts);
+};
@@ -0,0 +1,216 @@
+#include "CommandKernels.h"
+
+#include <cmath>
+
+#define COMMAND_VALUE_COLUMNS	20
+#define COMMAND_FLAG_COLUMNS	8
+
+MotorCommands::MotorCommands(size_t capacity) : _capacity(capacity)
+{
+	// Columns are padded to whole cache lines, the slack lets the first one be aligned
+	size_t perLine = COMMAND_ALIGN_BYTES / sizeof(double);
+	_stride = (capacity + perLine - 1) / perLine * perLine;
+
+	_values.assign(COMMAND_VALUE_COLUMNS * _stride + perLine, 0.0);
+	_flags.assign(COMMAND_FLAG_COLUMNS * _stride + COMMAND_ALIGN_BYTES, 0);
+
+	InputPos		= valueColumn(0);
+	CountsPerUnit	= valueColumn(1);
+	CmpPos			= valueColumn(2);
+	PrevCmpPos		= valueColumn(3);
+	CmdVel			= valueColumn(4);
+	CmdAcc			= valueColumn(5);
+	RawPos			= valueColumn(6);
+	FilteredPos		= valueColumn(7);
+	VelCap			= valueColumn(8);
+	AccScale		= valueColumn(9);
+	PosMin			= valueColumn(10);
+	PosMax			= valueColumn(11);
+	VelMax			= valueColumn(12);
+	AccMax			= valueColumn(13);
+	TargetPos		= valueColumn(14);
+	TargetVel		= valueColumn(15);
+	TargetAcc		= valueColumn(16);
+	SentPos			= valueColumn(17);
+	SentVel			= valueColumn(18);
+	SentAcc			= valueColumn(19);
+
+	HasCommand		= flagColumn(0);
+	CommandChanged	= flagColumn(1);
+	TargetValid		= flagColumn(2);
+	Clamped			= flagColumn(3);
+	SentValid		= flagColumn(4);
+	PosChanged		= flagColumn(5);
+	Changed			= flagColumn(6);
+	Suppressed		= flagColumn(7);
+
+	NodeLimits unlimited;
+
+	for (size_t i = 0; i < capacity; i++)
+	{
+		CountsPerUnit[i] = 1.0;
+		AccScale[i] = 1.0;
+		setLimits(i, unlimited);
+	}
+}
+
+double* MotorCommands::valueColumn(size_t index)
+{
+	uintptr_t base = reinterpret_cast<uintptr_t>(_values.data());
+	uintptr_t aligned = (base + COMMAND_ALIGN_BYTES - 1) & ~uintptr_t(COMMAND_ALIGN_BYTES - 1);
+
+	return reinterpret_cast<double*>(aligned) + index * _stride;
+}
+
+uint8_t* MotorCommands::flagColumn(size_t index)
+{
+	uintptr_t base = reinterpret_cast<uintptr_t>(_flags.data());
+	uintptr_t aligned = (base + COMMAND_ALIGN_BYTES - 1) & ~uintptr_t(COMMAND_ALIGN_BYTES - 1);
+
+	return reinterpret_cast<uint8_t*>(aligned) + index * _stride;
+}
+
+void MotorCommands::setLimits(size_t axis, const NodeLimits& limits, bool unbounded)
+{
+	PosMin[axis] = unbounded ? -HUGE_VAL : (limits.SoftLimitsActive ? limits.SoftLimitMin : INT32_MIN);
+	PosMax[axis] = unbounded ? HUGE_VAL : (limits.SoftLimitsActive ? limits.SoftLimitMax : INT32_MAX);
+	VelMax[axis] = limits.Valid && limits.MaxVelRpm > 0.0 ? limits.MaxVelRpm : HUGE_VAL;
+	AccMax[axis] = limits.MaxAccRpmPerSec;
+}
+
+// The kernels below are written without branches or calls that would stop vectorization. Every
+// condition is a select or a blend between values of the same width as the data, flags included;
+// only the final store narrows it. Each takes its columns as restrict
+// parameters: they never overlap, but without saying so the compiler has to version every loop
+// for aliasing and gives up.
+
+static void convertColumns(size_t count, const double* __restrict inputPos, const double* __restrict countsPerUnit,
+	const uint8_t* __restrict hasCommand, double* __restrict cmpPos, double* __restrict prevCmpPos,
+	uint8_t* __restrict commandChanged)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double has = hasCommand[i];
+		double prev = cmpPos[i];
+		double cmp = inputPos[i] * countsPerUnit[i];
+
+		// Selects rather than blends, a NaN left on an input that went away must not reach the axis
+		cmpPos[i] = has != 0.0 ? cmp : prev;
+		prevCmpPos[i] = has != 0.0 ? prev : prevCmpPos[i];
+		commandChanged[i] = (uint8_t)(cmp != prev ? has : 0.0);
+	}
+}
+
+void convertCommands(MotorCommands& c, size_t count)
+{
+	convertColumns(count, c.InputPos, c.CountsPerUnit, c.HasCommand, c.CmpPos, c.PrevCmpPos, c.CommandChanged);
+}
+
+static uint32_t clampColumns(size_t count, const double* __restrict filteredPos, const double* __restrict cmdVel,
+	const double* __restrict cmdAcc, const double* __restrict velCap, const double* __restrict accScale,
+	const double* __restrict posMin, const double* __restrict posMax, const double* __restrict velMax,
+	const double* __restrict accMax, double* __restrict targetPos, double* __restrict targetVel,
+	double* __restrict targetAcc, uint8_t* __restrict targetValid, uint8_t* __restrict clamped)
+{
+	int64_t clampedAxes = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double pos = filteredPos[i];
+		double cap = velCap[i] > 0.0 ? velCap[i] : cmdVel[i];
+		double vel = cap < cmdVel[i] ? cap : cmdVel[i];
+		double acc = cmdAcc[i] * accScale[i];
+
+		// x - x is 0 for every finite value and NaN for infinities and NaN
+		double finite = pos - pos == 0.0 ? 1.0 : 0.0;
+		finite = vel - vel == 0.0 ? finite : 0.0;
+		finite = acc - acc == 0.0 ? finite : 0.0;
+
+		double clampedPos = pos < posMin[i] ? posMin[i] : pos;
+		clampedPos = clampedPos > posMax[i] ? posMax[i] : clampedPos;
+
+		double clampedVel = vel < VEL_LIM_MIN_RPM ? VEL_LIM_MIN_RPM : vel;
+		clampedVel = clampedVel > velMax[i] ? velMax[i] : clampedVel;
+
+		double clampedAcc = acc < ACC_LIM_MIN_RPM_PER_SEC ? ACC_LIM_MIN_RPM_PER_SEC : acc;
+		clampedAcc = clampedAcc > accMax[i] ? accMax[i] : clampedAcc;
+
+		// Combined as 64 bit integers, the same width as the values, since a conditional add of doubles could trap
+		int64_t flags = (clampedPos != pos ? (int64_t)CLAMP_POS : 0) | (clampedVel != vel ? (int64_t)CLAMP_VEL : 0)
+			| (clampedAcc != acc ? (int64_t)CLAMP_ACC : 0);
+		flags = finite != 0.0 ? flags : (int64_t)CLAMP_REJECT;
+
+		targetPos[i] = clampedPos;
+		targetVel[i] = clampedVel;
+		targetAcc[i] = clampedAcc;
+		targetValid[i] = (uint8_t)finite;
+		clamped[i] = (uint8_t)flags;
+
+		clampedAxes += flags != CLAMP_NONE;
+	}
+
+	return (uint32_t)clampedAxes;
+}
+
+uint32_t clampCommands(MotorCommands& c, size_t count)
+{
+	return clampColumns(count, c.FilteredPos, c.CmdVel, c.CmdAcc, c.VelCap, c.AccScale,
+		c.PosMin, c.PosMax, c.VelMax, c.AccMax, c.TargetPos, c.TargetVel, c.TargetAcc, c.TargetValid, c.Clamped);
+}
+
+static void diffPositionColumns(size_t count, double deadbandUnits, const double* __restrict countsPerUnit,
+	const double* __restrict targetPos, const double* __restrict sentPos, const uint8_t* __restrict sentValid,
+	uint8_t* __restrict posChanged)
+{
+	// A deadband has to be exceeded; without one, any target that rounds to another count moves
+	bool deadband = deadbandUnits > 0.0;
+	double atThreshold = deadband ? 0.0 : 1.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double distance = std::fabs(targetPos[i] - sentPos[i]);
+		double threshold = deadband ? deadbandUnits * std::fabs(countsPerUnit[i]) : 0.5;
+
+		double moved = distance > threshold ? 1.0 : 0.0;
+		moved = distance == threshold ? atThreshold : moved;
+
+		double valid = sentValid[i];
+
+		posChanged[i] = (uint8_t)(valid * moved + (1.0 - valid));
+	}
+}
+
+void diffPositions(MotorCommands& c, size_t count, double deadbandUnits)
+{
+	diffPositionColumns(count, deadbandUnits, c.CountsPerUnit, c.TargetPos, c.SentPos, c.SentValid, c.PosChanged);
+}
+
+static void diffCommandColumns(size_t count, const uint8_t* __restrict hasCommand,
+	const uint8_t* __restrict commandChanged, const uint8_t* __restrict sentValid, const uint8_t* __restrict posChanged, const double* __restrict rawPos, const double* __restrict targetVel,
+	const double* __restrict targetAcc, const double* __restrict sentPos, const double* __restrict sentVel,
+	const double* __restrict sentAcc, uint8_t* __restrict changed, uint8_t* __restrict suppressed)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double valid = sentValid[i];
+		double limits = targetVel[i] != sentVel[i] ? 1.0 : 0.0;
+		limits = targetAcc[i] != sentAcc[i] ? 1.0 : limits;
+
+		double moved = (double)posChanged[i];
+		moved = moved + limits - moved * limits;
+		moved = valid * moved + (1.0 - valid);
+
+		// A new raw input would have queued a move the filter or the deadband held back, counted once per change
+		double rawMoved = std::fabs(rawPos[i] - sentPos[i]) >= 0.5 ? 1.0 : 0.0;
+		double held = (double)(hasCommand[i] & commandChanged[i]) * (1.0 - moved);
+
+		changed[i] = (uint8_t)moved;
+		suppressed[i] = (uint8_t)(held * rawMoved);
+	}
+}
+
+void diffCommands(MotorCommands& c, size_t count)
+{
+	diffCommandColumns(count, c.HasCommand, c.CommandChanged, c.SentValid, c.PosChanged, c.RawPos, c.TargetVel, c.TargetAcc,
+		c.SentPos, c.SentVel, c.SentAcc, c.Changed, c.Suppressed);
+}
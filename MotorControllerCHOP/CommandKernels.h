@@ -0,0 +1,85 @@
+#pragma once
+
+#include "NodeLimits.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define COMMAND_ALIGN_BYTES		64		// Every column starts on a cache line
+
+// Command path state of every axis, one aligned column per field, so each stage below is a
+// straight loop over contiguous memory that the compiler vectorizes. Indexed by axis.
+class MotorCommands
+{
+private:
+	size_t _capacity;
+	size_t _stride;
+	std::vector<double> _values;
+	std::vector<uint8_t> _flags;
+
+	double* valueColumn(size_t index);
+	uint8_t* flagColumn(size_t index);
+
+public:
+	explicit MotorCommands(size_t capacity);
+
+	MotorCommands(const MotorCommands&) = delete;
+	MotorCommands& operator=(const MotorCommands&) = delete;
+
+	size_t capacity() const { return _capacity; }
+
+	// An unbounded axis has no position range, the drive's soft limits cannot follow its folded counter
+	void setLimits(size_t axis, const NodeLimits& limits, bool unbounded = false);
+
+	// Input, position in input units and converted to counts
+	double*		InputPos;
+	double*		CountsPerUnit;
+	double*		CmpPos;
+	double*		PrevCmpPos;
+	double*		CmdVel;
+	double*		CmdAcc;
+
+	// Written by the stages between the input and the clamp
+	double*		RawPos;				// CmpPos less what frame gap bridging still holds back
+	double*		FilteredPos;		// Whole counts
+	double*		VelCap;				// 0 leaves CmdVel as it is
+	double*		AccScale;
+
+	// Drive limits, copied when the topology changes
+	double*		PosMin;
+	double*		PosMax;
+	double*		VelMax;
+	double*		AccMax;
+
+	// Command after clamping, this is what reaches the bus
+	double*		TargetPos;
+	double*		TargetVel;
+	double*		TargetAcc;
+
+	// Last move the drive accepted, a move is only started again when the target differs
+	double*		SentPos;
+	double*		SentVel;
+	double*		SentAcc;
+
+	uint8_t*	HasCommand;			// The input carries at least a position for this axis
+	uint8_t*	CommandChanged;
+	uint8_t*	TargetValid;
+	uint8_t*	Clamped;			// CLAMP_* flags
+	uint8_t*	SentValid;
+	uint8_t*	PosChanged;
+	uint8_t*	Changed;
+	uint8_t*	Suppressed;			// The raw input changed and differs from what was sent but no move goes out
+};
+
+// CmpPos = InputPos * CountsPerUnit for every axis with a command
+void convertCommands(MotorCommands& commands, size_t count);
+
+// Target = FilteredPos, CmdVel under VelCap, CmdAcc * AccScale, brought inside the limits. Returns the axes clamped.
+uint32_t clampCommands(MotorCommands& commands, size_t count);
+
+// PosChanged: the target moved off the sent position by more than the deadband, or half a count without one
+void diffPositions(MotorCommands& commands, size_t count, double deadbandUnits);
+
+// Changed and Suppressed, after anything that still adjusts TargetVel and TargetAcc or drops SentValid
+void diffCommands(MotorCommands& commands, size_t count);
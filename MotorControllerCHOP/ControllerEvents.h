@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#define EVENT_QUEUE_CAPACITY	256		// Must be a power of two
+#define EVENT_MESSAGE_LEN		128
+#define EVENT_NO_NODE			-1
+#define EVENT_NOTICE			0		// ErrorCode of an informational event, MN_OK
+
+// Controller operation that raised an event
+enum EventOp : uint8_t
+{
+	OP_CONNECT = 0,
+	OP_HOME,
+	OP_ENABLE,
+	OP_MOVE,
+	OP_TELEMETRY,
+	OP_COOK,
+	OP_TOPOLOGY,
+	OP_COUNT
+};
+
+inline const char* eventOpName(EventOp op)
+{
+	static const char* names[OP_COUNT] = { "connect", "home", "enable", "move", "telemetry", "cook", "topology" };
+	return op < OP_COUNT ? names[op] : "unknown";
+}
+
+struct ControllerEvent
+{
+	double		TimestampMsec	= 0.0;
+	int32_t		Node			= EVENT_NO_NODE;
+	uint32_t	ErrorCode		= 0;		// cnErrCode as reported by sFoundation
+	EventOp		Op				= OP_CONNECT;
+	char		Message[EVENT_MESSAGE_LEN] = {};
+};
+
+// Bounded lock-free multi-producer/multi-consumer ring. Every slot is allocated up front,
+// so reporting an error never allocates; when the ring is full the event is dropped and counted.
+class EventRing
+{
+private:
+	struct Slot
+	{
+		std::atomic<size_t>	Sequence;
+		ControllerEvent		Event;
+	};
+
+	Slot					_slots[EVENT_QUEUE_CAPACITY];
+	std::atomic<size_t>		_head{ 0 };
+	std::atomic<size_t>		_tail{ 0 };
+	std::atomic<uint32_t>	_dropped{ 0 };
+
+public:
+	EventRing()
+	{
+		for (size_t i = 0; i < EVENT_QUEUE_CAPACITY; i++)
+			_slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	EventRing(const EventRing&) = delete;
+	EventRing& operator=(const EventRing&) = delete;
+
+	bool push(int32_t iNode, uint32_t errorCode, EventOp op, double timestampMsec, const char* message)
+	{
+		size_t pos = _head.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Slot& slot = _slots[pos & (EVENT_QUEUE_CAPACITY - 1)];
+			size_t seq = slot.Sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+			if (diff == 0)
+			{
+				if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					slot.Event.TimestampMsec	= timestampMsec;
+					slot.Event.Node				= iNode;
+					slot.Event.ErrorCode		= errorCode;
+					slot.Event.Op				= op;
+					snprintf(slot.Event.Message, EVENT_MESSAGE_LEN, "%s", message ? message : "");
+
+					slot.Sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				_dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				pos = _head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool pop(ControllerEvent& event)
+	{
+		size_t pos = _tail.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Slot& slot = _slots[pos & (EVENT_QUEUE_CAPACITY - 1)];
+			size_t seq = slot.Sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+			if (diff == 0)
+			{
+				if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					event = slot.Event;
+					slot.Sequence.store(pos + EVENT_QUEUE_CAPACITY, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = _tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	uint32_t dropped() const
+	{
+		return _dropped.load(std::memory_order_relaxed);
+	}
+};
+
+// Errors and informational events in rings of their own, so no number of notices can push out an error
+class EventQueue
+{
+private:
+	EventRing	_errors;
+	EventRing	_notices;
+
+public:
+	bool push(int32_t iNode, uint32_t errorCode, EventOp op, double timestampMsec, const char* message)
+	{
+		EventRing& ring = errorCode == EVENT_NOTICE ? _notices : _errors;
+		return ring.push(iNode, errorCode, op, timestampMsec, message);
+	}
+
+	// Errors first, then notices
+	bool pop(ControllerEvent& event)
+	{
+		return _errors.pop(event) || _notices.pop(event);
+	}
+
+	// Errors only, a lost notice is nothing to alarm anyone about
+	uint32_t dropped() const
+	{
+		return _errors.dropped();
+	}
+};
@@ -0,0 +1,54 @@
+#include "CoordinatedMoves.h"
+
+#include <cmath>
+#include <vector>
+
+void coordinateGroups(
+	size_t count,
+	const int32_t* group,
+	const double* distanceCnts,
+	const double* countsPerRev,
+	double* velRpm,
+	double* accRpmPerSec,
+	double groupDurationMsec[COORD_GROUP_MAX + 1])
+{
+	// Scratch kept across calls, the cook never allocates once it has seen the largest axis count
+	static thread_local std::vector<double> duration;
+
+	if (duration.size() < count)
+		duration.resize(count);
+
+	// Profile time of every axis on its own. Written without branches so the loop vectorizes.
+	for (size_t i = 0; i < count; i++)
+	{
+		double distance = std::fabs(distanceCnts[i]);
+		double vel = velRpm[i] * countsPerRev[i] / 60000.0;
+		double acc = accRpmPerSec[i] * countsPerRev[i] / 60.0 / 1.0e6;
+
+		vel = vel > 1.0e-12 ? vel : 1.0e-12;
+		acc = acc > 1.0e-12 ? acc : 1.0e-12;
+
+		double triangular = 2.0 * std::sqrt(distance / acc);
+		double trapezoid = distance / vel + vel / acc;
+
+		duration[i] = distance * acc < vel * vel ? triangular : trapezoid;
+	}
+
+	for (size_t g = 0; g <= COORD_GROUP_MAX; g++)
+		groupDurationMsec[g] = 0.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double& slowest = groupDurationMsec[group[i]];
+		slowest = duration[i] > slowest ? duration[i] : slowest;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		double shared = groupDurationMsec[group[i]];
+		double k = group[i] != 0 && shared > 0.0 ? duration[i] / shared : 1.0;
+
+		velRpm[i] *= k;
+		accRpmPerSec[i] *= k * k;
+	}
+}
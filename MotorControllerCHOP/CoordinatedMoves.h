@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define COORD_GROUP_MAX		15		// Group 0 moves on its own, groups 1..15 map to drive trigger groups
+
+// Scales the velocity and acceleration of every axis in a group so all of them take as long as the
+// slowest one. Scaling velocity by k and acceleration by k^2 keeps the shape of each profile and
+// stretches its duration by 1/k, so every axis arrives together. Axes with group 0 are left alone.
+// Durations are those of a symmetric trapezoid, the shape every grouped axis is sent with.
+// Arrays are per axis; groupDuration receives the shared profile time (ms) of each group.
+void coordinateGroups(
+	size_t count,
+	const int32_t* group,
+	const double* distanceCnts,
+	const double* countsPerRev,
+	double* velRpm,
+	double* accRpmPerSec,
+	double groupDurationMsec[COORD_GROUP_MAX + 1]);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CPlusPlus_Common.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Which table DAT was read last and at which of its cooks. A DAT cooks whenever its contents change,
+// so a table is only parsed again when it is another operator or has cooked since.
+struct DatVersion
+{
+	uint32_t	OpId		= 0;
+	int64_t		TotalCooks	= -1;
+
+	bool matches(const OP_DATInput* table) const
+	{
+		uint32_t opId = table != nullptr ? table->opId : 0;
+		int64_t totalCooks = table != nullptr ? table->totalCooks : -1;
+
+		return opId == OpId && totalCooks == TotalCooks;
+	}
+
+	void set(const OP_DATInput* table)
+	{
+		OpId = table != nullptr ? table->opId : 0;
+		TotalCooks = table != nullptr ? table->totalCooks : -1;
+	}
+
+	// Returns true, and takes the table as read, when it differs from the one read last
+	bool changed(const OP_DATInput* table)
+	{
+		if (matches(table))
+			return false;
+
+		set(table);
+		return true;
+	}
+};
+
+// The tables are hand edited; a header row or a line that does not parse is skipped, so every row
+// goes through these and is dropped when one of its cells fails
+
+inline bool parseAxisCell(const char* cell, size_t axisCount, size_t& axis)
+{
+	char* end = nullptr;
+	long value = strtol(cell, &end, 10);
+
+	if (end == cell || value < 0 || (size_t)value >= axisCount)
+		return false;
+
+	axis = (size_t)value;
+	return true;
+}
+
+inline bool parseNumberCell(const char* cell, double& value)
+{
+	char* end = nullptr;
+	value = strtod(cell, &end);
+
+	return end != cell && std::isfinite(value);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#define FRAME_GAP_THRESHOLD			1.5		// deltaFrames above this means TouchDesigner dropped frames
+#define FRAME_GAP_MAX_BRIDGE		30.0	// Longer gaps are bridged over this many frames at most
+#define FRAME_GAP_VEL_HEADROOM		1.25	// Rescaled moves may run this much faster than the input did
+
+// What the command path does with the position jump left by dropped frames
+enum FrameGapMode
+{
+	FRAME_GAP_OFF = 0,
+	FRAME_GAP_INTERPOLATE,		// Send one frame's share now, release the rest over the frames that were missed
+	FRAME_GAP_RESCALE,			// Send the whole jump at the speed the input was moving
+	FRAME_GAP_MODE_COUNT
+};
+
+// Cook-to-cook timing taken from OP_TimeInfo, counted over the life of the CHOP
+struct FrameGapStats
+{
+	int64_t		LastAbsFrame		= -1;
+	double		DeltaFrames			= 1.0;
+	double		DeltaMsec			= 0.0;
+	uint32_t	Gaps				= 0;
+	double		DroppedFrames		= 0.0;
+	double		WorstFrames			= 0.0;	// Frames missed by the longest gap
+	double		WorstMsec			= 0.0;
+
+	// The CHOP stopped cooking on purpose, the frames until the next cook were not dropped
+	void restart()
+	{
+		LastAbsFrame = -1;
+	}
+
+	// Returns true when frames were dropped since the previous cook
+	bool update(int64_t absFrame, double deltaFrames, double deltaMsec)
+	{
+		bool first = LastAbsFrame < 0;
+
+		LastAbsFrame = absFrame;
+		DeltaFrames = deltaFrames;
+		DeltaMsec = deltaMsec;
+
+		if (first || deltaFrames <= FRAME_GAP_THRESHOLD)
+			return false;
+
+		double dropped = deltaFrames - 1.0;
+
+		Gaps++;
+		DroppedFrames += dropped;
+
+		if (dropped > WorstFrames)
+		{
+			WorstFrames = dropped;
+			WorstMsec = deltaMsec;
+		}
+
+		return true;
+	}
+};
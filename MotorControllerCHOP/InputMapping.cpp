@@ -0,0 +1,156 @@
+#include "InputMapping.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+bool parseInputField(const char* name, InputField& field)
+{
+	static const char* names[INPUT_FIELD_COUNT] = { "pos", "vel", "acc", "group", "profile", "dec", "jerk", "head", "tail", "htvel" };
+
+	for (int i = 0; i < INPUT_FIELD_COUNT; i++)
+	{
+		if (strcmp(name, names[i]) == 0)
+		{
+			field = (InputField)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool parseChannelName(const char* name, size_t& axis, InputField& field)
+{
+	// m<axis>_<field>, the same naming as the output channels
+	if (name == nullptr || name[0] != 'm' || name[1] < '0' || name[1] > '9')
+		return false;
+
+	char* end = nullptr;
+	unsigned long value = strtoul(name + 1, &end, 10);
+
+	if (end == nullptr || *end != '_')
+		return false;
+
+	axis = (size_t)value;
+	return parseInputField(end + 1, field);
+}
+
+InputMapping::InputMapping(size_t maxAxes) : _maxAxes(maxAxes), _channel(maxAxes * INPUT_FIELD_COUNT, INPUT_NO_CHANNEL)
+{
+}
+
+bool InputMapping::layoutChanged(const OP_CHOPInput* input, const OP_DATInput* table)
+{
+	if (!_resolved)
+		return true;
+
+	if (!_table.matches(table))
+		return true;
+
+	if (input->opId != _inputId || (size_t)input->numChannels != _names.size())
+		return true;
+
+	// Name pointers are normally stable while the layout is, so strings are only compared when one moved
+	for (int32_t i = 0; i < input->numChannels; i++)
+	{
+		const char* name = input->getChannelName(i);
+
+		if (name == _namePointers[i])
+			continue;
+
+		if (_names[i] != name)
+			return true;
+
+		_namePointers[i] = name;
+	}
+
+	return false;
+}
+
+void InputMapping::map(size_t axis, InputField field, int32_t channel)
+{
+	if (axis >= _maxAxes)
+		return;
+
+	_channel[axis * INPUT_FIELD_COUNT + field] = channel;
+
+	if (axis + 1 > _axisCount)
+		_axisCount = axis + 1;
+}
+
+void InputMapping::resolve(const OP_CHOPInput* input, const OP_DATInput* table)
+{
+	std::fill(_channel.begin(), _channel.end(), INPUT_NO_CHANNEL);
+	_axisCount = 0;
+
+	_inputId = input->opId;
+	_namePointers.resize(input->numChannels);
+	_names.resize(input->numChannels);
+
+	for (int32_t i = 0; i < input->numChannels; i++)
+	{
+		_namePointers[i] = input->getChannelName(i);
+		_names[i] = _namePointers[i];
+	}
+
+	_table.set(table);
+
+	if (table != nullptr && table->isTable && table->numCols >= 3)
+	{
+		// The table replaces name matching
+		for (int32_t row = 0; row < table->numRows; row++)
+		{
+			size_t axis;
+			InputField field;
+
+			if (!parseAxisCell(table->getCell(row, 1), _maxAxes, axis) || !parseInputField(table->getCell(row, 2), field))
+				continue;
+
+			for (int32_t i = 0; i < input->numChannels; i++)
+			{
+				if (_names[i] == table->getCell(row, 0))
+				{
+					map(axis, field, i);
+					break;
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int32_t i = 0; i < input->numChannels; i++)
+		{
+			size_t axis;
+			InputField field;
+
+			if (parseChannelName(_names[i].c_str(), axis, field))
+				map(axis, field, i);
+		}
+	}
+
+	_resolved = true;
+	_generation++;
+}
+
+bool InputMapping::update(const OP_CHOPInput* input, const OP_DATInput* table)
+{
+	if (input == nullptr)
+	{
+		if (_resolved)
+		{
+			std::fill(_channel.begin(), _channel.end(), INPUT_NO_CHANNEL);
+			_axisCount = 0;
+			_resolved = false;
+			_generation++;
+		}
+
+		return false;
+	}
+
+	if (!layoutChanged(input, table))
+		return false;
+
+	resolve(input, table);
+	return true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CPlusPlus_Common.h"
+#include "DatTable.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define INPUT_NO_CHANNEL	-1
+
+// Command carried by one input channel
+enum InputField
+{
+	INPUT_POS = 0,
+	INPUT_VEL,
+	INPUT_ACC,
+	INPUT_GROUP,
+	INPUT_PROFILE,			// Move profile settings, in MoveProfileField order from here on
+	INPUT_DEC,
+	INPUT_JERK,
+	INPUT_HEAD,
+	INPUT_TAIL,
+	INPUT_HEAD_TAIL_VEL,
+	INPUT_FIELD_COUNT
+};
+
+// Where every axis' commands live in a single wide input CHOP. Channels are matched by name
+// (m0_pos, m0_vel, m0_acc, m0_group, m0_profile, m0_dec, m0_jerk, m0_head, m0_tail, m0_htvel, ...)
+// or by a mapping table DAT with rows of channel, axis, field.
+// Names are only looked at when the input's layout or the table changes; every other cook
+// reads straight through the index table.
+class InputMapping
+{
+private:
+	size_t _maxAxes;
+	std::vector<int32_t> _channel;		// [axis * INPUT_FIELD_COUNT + field]
+	size_t _axisCount = 0;
+	uint32_t _generation = 0;
+
+	// Layout the index table was resolved for
+	bool _resolved = false;
+	uint32_t _inputId = 0;
+	std::vector<const char*> _namePointers;
+	std::vector<std::string> _names;
+	DatVersion _table;
+
+	bool layoutChanged(const OP_CHOPInput* input, const OP_DATInput* table);
+	void resolve(const OP_CHOPInput* input, const OP_DATInput* table);
+	void map(size_t axis, InputField field, int32_t channel);
+
+public:
+	explicit InputMapping(size_t maxAxes);
+
+	// Returns true when the index table was rebuilt
+	bool update(const OP_CHOPInput* input, const OP_DATInput* table);
+
+	size_t axisCount() const { return _axisCount; }		// Highest mapped axis + 1
+	uint32_t generation() const { return _generation; }
+
+	int32_t channel(size_t axis, InputField field) const
+	{
+		return _channel[axis * INPUT_FIELD_COUNT + field];
+	}
+
+	// Velocity and acceleration may be left out, the axis then runs at the default limits
+	bool hasPosition(size_t axis) const
+	{
+		return channel(axis, INPUT_POS) >= 0;
+	}
+};
+
+bool parseInputField(const char* name, InputField& field);
+bool parseChannelName(const char* name, size_t& axis, InputField& field);
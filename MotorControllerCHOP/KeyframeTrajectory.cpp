@@ -0,0 +1,218 @@
+#include "KeyframeTrajectory.h"
+
+#include <algorithm>
+#include <cmath>
+
+void fillKeyframeVelocities(std::vector<Keyframe>& keys)
+{
+	size_t count = keys.size();
+
+	for (size_t k = 0; k < count; k++)
+	{
+		Keyframe& key = keys[k];
+
+		if (key.HasVel)
+			continue;
+
+		key.Vel = 0.0;
+
+		if (k == 0 || k + 1 == count)
+			continue;
+
+		double h0 = key.TimeSec - keys[k - 1].TimeSec;
+		double h1 = keys[k + 1].TimeSec - key.TimeSec;
+		double d0 = (key.Pos - keys[k - 1].Pos) / h0;
+		double d1 = (keys[k + 1].Pos - key.Pos) / h1;
+
+		// Keeps every segment monotone, so the axis never travels past a keyframe and back
+		if (d0 * d1 > 0.0)
+			key.Vel = 3.0 * (h0 + h1) / ((2.0 * h1 + h0) / d0 + (h1 + 2.0 * h0) / d1);
+	}
+}
+
+KeyframeTrajectory::KeyframeTrajectory(size_t capacity) :
+	_capacity(capacity),
+	_keys(capacity),
+	_c0(capacity, 0.0),
+	_c1(capacity, 0.0),
+	_c2(capacity, 0.0),
+	_c3(capacity, 0.0),
+	_segmentStart(capacity, 0.0),
+	_segmentSec(capacity, 0.0),
+	_segment(capacity, 0),
+	_setpoint(capacity, 0.0),
+	_velocity(capacity, 0.0)
+{
+}
+
+bool KeyframeTrajectory::update(const OP_DATInput* table)
+{
+	// Only parsed when the table changed, every other cook evaluates the segments already set up
+	if (!_table.changed(table))
+		return false;
+
+	parse(table);
+	return true;
+}
+
+void KeyframeTrajectory::parse(const OP_DATInput* table)
+{
+	for (size_t i = 0; i < _capacity; i++)
+		_keys[i].clear();
+
+	_axisCount = 0;
+	_durationSec = 0.0;
+
+	if (table != nullptr && table->isTable && table->numCols >= 3)
+	{
+		for (int32_t row = 0; row < table->numRows; row++)
+		{
+			size_t axis;
+			Keyframe key;
+
+			if (!parseAxisCell(table->getCell(row, 0), _capacity, axis)
+				|| !parseNumberCell(table->getCell(row, 1), key.TimeSec) || !parseNumberCell(table->getCell(row, 2), key.Pos))
+				continue;
+
+			key.HasVel = table->numCols >= 4 && parseNumberCell(table->getCell(row, 3), key.Vel);
+
+			_keys[axis].push_back(key);
+		}
+	}
+
+	for (size_t i = 0; i < _capacity; i++)
+	{
+		std::vector<Keyframe>& keys = _keys[i];
+
+		// Rows may come in any order; of two keyframes at the same time the later row wins
+		std::stable_sort(keys.begin(), keys.end(), [](const Keyframe& a, const Keyframe& b) { return a.TimeSec < b.TimeSec; });
+
+		size_t kept = 0;
+
+		for (size_t k = 0; k < keys.size(); k++)
+		{
+			if (kept > 0 && keys[k].TimeSec == keys[kept - 1].TimeSec)
+				kept--;
+
+			keys[kept++] = keys[k];
+		}
+
+		keys.resize(kept);
+		fillKeyframeVelocities(keys);
+
+		if (!keys.empty())
+		{
+			_axisCount = i + 1;
+			_durationSec = std::max(_durationSec, keys.back().TimeSec);
+		}
+
+		selectSegment(i, 0);
+	}
+}
+
+void KeyframeTrajectory::selectSegment(size_t axis, size_t segment)
+{
+	const std::vector<Keyframe>& keys = _keys[axis];
+
+	_segment[axis] = segment;
+
+	if (keys.empty())
+	{
+		_c0[axis] = _c1[axis] = _c2[axis] = _c3[axis] = 0.0;
+		_segmentStart[axis] = _segmentSec[axis] = 0.0;
+		return;
+	}
+
+	const Keyframe& from = keys[segment];
+
+	_c0[axis] = from.Pos;
+	_c1[axis] = _c2[axis] = _c3[axis] = 0.0;
+	_segmentStart[axis] = from.TimeSec;
+	_segmentSec[axis] = 0.0;
+
+	if (segment + 1 >= keys.size())
+		return;
+
+	// Cubic Hermite in seconds since the segment started, through both keyframes at their velocities
+	const Keyframe& to = keys[segment + 1];
+	double h = to.TimeSec - from.TimeSec;
+	double slope = (to.Pos - from.Pos) / h;
+
+	_c1[axis] = from.Vel;
+	_c2[axis] = (3.0 * slope - 2.0 * from.Vel - to.Vel) / h;
+	_c3[axis] = (from.Vel + to.Vel - 2.0 * slope) / (h * h);
+	_segmentSec[axis] = h;
+}
+
+void KeyframeTrajectory::play(double nowSec, bool loop)
+{
+	_playing = true;
+	_loop = loop;
+	_startSec = nowSec;
+	_playheadSec = 0.0;
+}
+
+// Written like the kernels in CommandKernels.cpp: restrict columns and selects only, so it vectorizes
+static void evaluateColumns(size_t count, double timeSec, double velocityScale, const double* __restrict c0,
+	const double* __restrict c1, const double* __restrict c2, const double* __restrict c3,
+	const double* __restrict segmentStart, const double* __restrict segmentSec, double* __restrict setpoint,
+	double* __restrict velocity)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		double u = timeSec - segmentStart[i];
+
+		u = u > 0.0 ? u : 0.0;
+		u = u < segmentSec[i] ? u : segmentSec[i];
+
+		setpoint[i] = ((c3[i] * u + c2[i]) * u + c1[i]) * u + c0[i];
+		velocity[i] = ((3.0 * c3[i] * u + 2.0 * c2[i]) * u + c1[i]) * velocityScale;
+	}
+}
+
+const double* KeyframeTrajectory::evaluate(double nowSec)
+{
+	if (_playing)
+	{
+		double t = nowSec > _startSec ? nowSec - _startSec : 0.0;
+
+		if (_loop && _durationSec > 0.0)
+		{
+			t = std::fmod(t, _durationSec);
+		}
+		else if (t >= _durationSec)
+		{
+			t = _durationSec;
+			_playing = false;
+		}
+
+		_playheadSec = t;
+	}
+
+	double t = _playheadSec;
+
+	// Only an axis that crossed a keyframe, or looped back, needs new coefficients
+	for (size_t i = 0; i < _axisCount; i++)
+	{
+		const std::vector<Keyframe>& keys = _keys[i];
+		size_t segment = _segment[i];
+
+		if (keys.size() < 2)
+			continue;
+
+		if (t < keys[segment].TimeSec)
+			segment = 0;
+
+		while (segment + 2 < keys.size() && t >= keys[segment + 1].TimeSec)
+			segment++;
+
+		if (segment != _segment[i])
+			selectSegment(i, segment);
+	}
+
+	// Held, or at the end, the curve still has a slope but the axis is standing still
+	evaluateColumns(_axisCount, t, _playing ? 1.0 : 0.0, _c0.data(), _c1.data(), _c2.data(), _c3.data(),
+		_segmentStart.data(), _segmentSec.data(), _setpoint.data(), _velocity.data());
+
+	return _setpoint.data();
+}
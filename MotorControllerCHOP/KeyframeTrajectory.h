@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CPlusPlus_Common.h"
+#include "DatTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define KEYFRAME_VEL_HEADROOM	2.5		// Velocity limit over the curve's speed, see KeyframeTrajectory
+// One authored point of an axis, in input position units
+struct Keyframe
+{
+	double	TimeSec		= 0.0;
+	double	Pos			= 0.0;
+	double	Vel			= 0.0;		// Units per second
+	bool	HasVel		= false;	// Without one the velocity is chosen so the curve never overshoots
+};
+
+// Sparse keyframes from a table DAT with rows of axis, time (s), position and optionally velocity,
+// played back on the host. Each pair of keyframes is a cubic Hermite segment. The segment every
+// axis is in is kept as coefficients by field, so a cook evaluates all axes in one loop and only
+// goes back to the keyframes when an axis crosses into its next segment.
+//
+// Playback is stepwise: every bus cycle sends the current setpoint as a move of its own, and the drive
+// runs each one from rest to rest. Each step's velocity limit is worked out from the distance it has to
+// cover within the cycle, twice the average speed plus margin, so the axis keeps pace with the curve
+// instead of rushing to each point at the default velocity and waiting there.
+class KeyframeTrajectory
+{
+private:
+	size_t _capacity;
+	std::vector<std::vector<Keyframe>> _keys;
+	size_t _axisCount = 0;
+	double _durationSec = 0.0;
+
+	// Active segment of every axis, position = ((C3 * u + C2) * u + C1) * u + C0 for u in [0, SegmentSec]
+	std::vector<double> _c0;
+	std::vector<double> _c1;
+	std::vector<double> _c2;
+	std::vector<double> _c3;
+	std::vector<double> _segmentStart;
+	std::vector<double> _segmentSec;
+	std::vector<size_t> _segment;
+	std::vector<double> _setpoint;
+	std::vector<double> _velocity;
+
+	// Table the keyframes were parsed from
+	DatVersion _table;
+
+	// Playback on the host clock; stopped, the playhead stays where it was
+	bool _playing = false;
+	bool _loop = false;
+	double _startSec = 0.0;
+	double _playheadSec = 0.0;
+
+	void parse(const OP_DATInput* table);
+	void selectSegment(size_t axis, size_t segment);
+
+public:
+	explicit KeyframeTrajectory(size_t capacity);
+
+	// Returns true when the keyframes were parsed again
+	bool update(const OP_DATInput* table);
+
+	void play(double nowSec, bool loop);
+	void stop() { _playing = false; }
+	bool isPlaying() const { return _playing; }
+
+	bool hasKeys(size_t axis) const { return axis < _axisCount && !_keys[axis].empty(); }
+	size_t axisCount() const { return _axisCount; }		// Highest axis with keyframes + 1
+	double durationSec() const { return _durationSec; }
+	double playheadSec() const { return _playheadSec; }
+
+	// Setpoint at host time nowSec of every axis below axisCount(). Before playback starts an axis
+	// holds its first keyframe, once it ends its last.
+	const double* evaluate(double nowSec);
+
+	// Speed of the curve at the last evaluate, in units per second; 0 unless playing
+	const double* velocity() const { return _velocity.data(); }
+};
+
+// Velocities for the keyframes that have none: at rest at both ends, in between the weighted harmonic
+// mean of the neighbouring slopes (Fritsch-Butland), zero where the motion turns around
+void fillKeyframeVelocities(std::vector<Keyframe>& keys);
@@ -0,0 +1,117 @@
+#include "LatencyProbe.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LatencyProbe::arm(double cookMsec, double sendStartMsec, double sendEndMsec,
+	double commanded, double measured, double accCntsPerMsec2)
+{
+	_state = PROBE_WAIT_PLANNING;
+
+	_cookMsec = cookMsec;
+	_sendStartMsec = sendStartMsec;
+	_sendEndMsec = sendEndMsec;
+	_lastSampleMsec = sendEndMsec;
+
+	_startCommanded = commanded;
+	_startMeasured = measured;
+	_accCntsPerMsec2 = accCntsPerMsec2;
+}
+
+void LatencyProbe::sample(double timeMsec, double commanded, double measured)
+{
+	if (_state == PROBE_IDLE)
+		return;
+
+	if (timeMsec - _sendEndMsec > LATENCY_TIMEOUT_MSEC)
+	{
+		_state = PROBE_IDLE;
+		return;
+	}
+
+	if (_state == PROBE_WAIT_PLANNING)
+	{
+		double distance = std::fabs(commanded - _startCommanded);
+
+		if (distance >= LATENCY_ONSET_CNTS)
+		{
+			_planOnsetMsec = estimateOnset(timeMsec, distance);
+			_state = PROBE_WAIT_MOTION;
+		}
+	}
+
+	if (_state == PROBE_WAIT_MOTION)
+	{
+		double distance = std::fabs(measured - _startMeasured);
+
+		if (distance >= LATENCY_ONSET_CNTS)
+			complete((std::max)(estimateOnset(timeMsec, distance), _planOnsetMsec));
+	}
+
+	_lastSampleMsec = timeMsec;
+}
+
+void LatencyProbe::reset()
+{
+	_state = PROBE_IDLE;
+	_historyCount = 0;
+}
+
+double LatencyProbe::estimateOnset(double sampleMsec, double distanceCnts) const
+{
+	// Samples arrive once per cook. Early in a move the profile is a parabola, so back-project
+	// the distance travelled to when it started, bounded by the previous sample.
+	double onset = sampleMsec;
+
+	if (_accCntsPerMsec2 > 0.0)
+		onset = sampleMsec - std::sqrt(2.0 * distanceCnts / _accCntsPerMsec2);
+
+	return (std::max)(onset, _lastSampleMsec);
+}
+
+void LatencyProbe::complete(double motionOnsetMsec)
+{
+	double* entry = _history[_historyCount % LATENCY_HISTORY];
+
+	entry[STAGE_QUEUE]		= _sendStartMsec - _cookMsec;
+	entry[STAGE_SERIAL]		= _sendEndMsec - _sendStartMsec;
+	entry[STAGE_PLANNING]	= _planOnsetMsec - _sendEndMsec;
+	entry[STAGE_MECHANICAL]	= motionOnsetMsec - _planOnsetMsec;
+	entry[STAGE_TOTAL]		= motionOnsetMsec - _cookMsec;
+
+	_historyCount++;
+	_state = PROBE_IDLE;
+}
+
+size_t LatencyProbe::count() const
+{
+	return (std::min)(_historyCount, (size_t)LATENCY_HISTORY);
+}
+
+double LatencyProbe::mean(LatencyStage stage) const
+{
+	size_t n = count();
+	double sum = 0.0;
+
+	for (size_t i = 0; i < n; i++)
+		sum += _history[i][stage];
+
+	return n > 0 ? sum / n : 0.0;
+}
+
+double LatencyProbe::percentile(LatencyStage stage, double fraction) const
+{
+	size_t n = count();
+	double values[LATENCY_HISTORY];
+
+	if (n == 0)
+		return 0.0;
+
+	for (size_t i = 0; i < n; i++)
+		values[i] = _history[i][stage];
+
+	size_t k = (size_t)(fraction * (n - 1) + 0.5);
+	std::nth_element(values, values + k, values + n);
+
+	return values[k];
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+#define LATENCY_HISTORY			64		// Probes kept per node for the rolling distribution
+#define LATENCY_TIMEOUT_MSEC	2000.0	// Give up on a probe whose motion never shows up
+#define LATENCY_ONSET_CNTS		2.0		// Position change that counts as motion onset
+#define LATENCY_REST_RPM		1.0		// Probes are only armed on an axis at rest
+
+enum LatencyStage
+{
+	STAGE_QUEUE = 0,	// Cook start until the move is handed to the bus
+	STAGE_SERIAL,		// Parameter writes and MovePosnStart round trips
+	STAGE_PLANNING,		// Move accepted until PosnCommanded starts changing
+	STAGE_MECHANICAL,	// PosnCommanded moving until PosnMeasured follows
+	STAGE_TOTAL,
+	STAGE_COUNT
+};
+
+// Measures command-to-motion latency of one node. A probe is armed when a new target is sent
+// to an axis at rest, and completes once both the commanded and the measured position moved.
+class LatencyProbe
+{
+private:
+	enum ProbeState
+	{
+		PROBE_IDLE,
+		PROBE_WAIT_PLANNING,
+		PROBE_WAIT_MOTION
+	};
+
+	ProbeState _state = PROBE_IDLE;
+
+	double _cookMsec = 0.0;
+	double _sendStartMsec = 0.0;
+	double _sendEndMsec = 0.0;
+	double _planOnsetMsec = 0.0;
+	double _lastSampleMsec = 0.0;
+
+	double _startCommanded = 0.0;
+	double _startMeasured = 0.0;
+	double _accCntsPerMsec2 = 0.0;
+
+	double _history[LATENCY_HISTORY][STAGE_COUNT] = {};
+	size_t _historyCount = 0;
+
+	double estimateOnset(double sampleMsec, double distanceCnts) const;
+	void complete(double motionOnsetMsec);
+
+public:
+	bool isArmed() const { return _state != PROBE_IDLE; }
+
+	void arm(double cookMsec, double sendStartMsec, double sendEndMsec,
+		double commanded, double measured, double accCntsPerMsec2);
+	void sample(double timeMsec, double commanded, double measured);
+	void reset();
+
+	size_t count() const;
+	double mean(LatencyStage stage) const;
+	double percentile(LatencyStage stage, double fraction) const;
+};
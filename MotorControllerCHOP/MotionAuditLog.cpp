@@ -0,0 +1,67 @@
+#include "MotionAuditLog.h"
+
+#include <cmath>
+
+void MotionAuditLog::push(const AuditRecord& record)
+{
+	_records[_count % AUDIT_HISTORY] = record;
+	_count++;
+}
+
+void MotionAuditLog::reset()
+{
+	_count = 0;
+}
+
+size_t MotionAuditLog::count() const
+{
+	return _count < AUDIT_HISTORY ? _count : AUDIT_HISTORY;
+}
+
+const AuditRecord& MotionAuditLog::latest() const
+{
+	static const AuditRecord none;
+
+	return _count > 0 ? _records[(_count - 1) % AUDIT_HISTORY] : none;
+}
+
+double MotionAuditLog::meanRMS() const
+{
+	size_t n = count();
+
+	if (n == 0)
+		return 0.0;
+
+	double sum = 0.0;
+
+	for (size_t i = 0; i < n; i++)
+		sum += _records[i].LowPassRMS;
+
+	return sum / n;
+}
+
+double MotionAuditLog::peak() const
+{
+	double worst = 0.0;
+
+	for (size_t i = 0; i < count(); i++)
+	{
+		worst = std::fmax(worst, std::fabs(_records[i].MaxPos));
+		worst = std::fmax(worst, std::fabs(_records[i].MaxNeg));
+	}
+
+	return worst;
+}
+
+double MotionAuditLog::worstTracking() const
+{
+	double worst = 0.0;
+
+	for (size_t i = 0; i < count(); i++)
+	{
+		worst = std::fmax(worst, std::fabs((double)_records[i].MaxTrackingPos));
+		worst = std::fmax(worst, std::fabs((double)_records[i].MaxTrackingNeg));
+	}
+
+	return worst;
+}
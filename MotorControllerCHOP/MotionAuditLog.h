@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define AUDIT_HISTORY					32		// Completed moves kept per node
+#define AUDIT_FILTER_MSEC				1.0		// Low-pass time constant of the in-drive collection
+#define AUDIT_FULL_SCALE_TRACKING_CNTS	100.0
+#define AUDIT_FULL_SCALE_TORQUE_PCT		100.0
+
+// Test point the drive collects statistics on, only Advanced nodes support it
+enum AuditMode : uint8_t
+{
+	AUDIT_OFF = 0,
+	AUDIT_TRACKING,
+	AUDIT_TORQUE_MEASURED,
+	AUDIT_TORQUE_COMMANDED,
+	AUDIT_MODE_COUNT
+};
+
+// mnAuditData of one completed move
+struct AuditRecord
+{
+	double		TimeMsec		= 0.0;	// Host time the results were read
+	AuditMode	Mode			= AUDIT_OFF;
+	double		LowPassRMS		= 0.0;
+	double		MaxPos			= 0.0;
+	double		MaxNeg			= 0.0;
+	double		HighPassRMS		= 0.0;
+	double		DurationMsec	= 0.0;
+	int32_t		MaxTrackingPos	= 0;	// Counts
+	int32_t		MaxTrackingNeg	= 0;
+};
+
+// Fixed-size ring of the latest audits of one node
+class MotionAuditLog
+{
+private:
+	AuditRecord _records[AUDIT_HISTORY];
+	size_t _count = 0;
+
+public:
+	void push(const AuditRecord& record);
+	void reset();
+
+	size_t count() const;
+	const AuditRecord& latest() const;
+
+	double meanRMS() const;
+	double peak() const;			// Largest excursion of the test point over the ring
+	double worstTracking() const;	// Counts
+};
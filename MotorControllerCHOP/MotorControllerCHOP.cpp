@@ -15,7 +15,9 @@
 #include "MotorControllerCHOP.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <cmath>
 #include <assert.h>
 
@@ -53,7 +55,7 @@ FillCHOPPluginInfo(CHOP_PluginInfo *info)
 	// This CHOP can work with 0 inputs
 	info->customOPInfo.minInputs = 0;
 
-	// It can accept up to 1 input though, which changes it's behavior
+	// One input per axis, or a single wide input in the Wide input mode
 	info->customOPInfo.maxInputs = 16;
 }
 
@@ -80,6 +82,9 @@ DestroyCHOPInstance(CHOP_CPlusPlusBase* instance)
 
 
 MotorControllerCHOP::MotorControllerCHOP(const OP_NodeInfo* info) : myNodeInfo(info)
+#ifndef SIMULATION
+	, motorController(controllerEvents)
+#endif // !SIMULATION
 {
 	updateNodeCount();
 }
@@ -91,8 +96,21 @@ MotorControllerCHOP::~MotorControllerCHOP()
 void
 MotorControllerCHOP::getGeneralInfo(CHOP_GeneralInfo* ginfo, const OP_Inputs* inputs, void* reserved1)
 {
-	// This will cause the node not to cook every frame
-	ginfo->cookEveryFrameIfAsked = true;
+	bool onDemand = inputs->getParInt("Cookondemand") != 0;
+
+	if (onDemand != cookOnDemand)
+	{
+		cookOnDemand = onDemand;
+
+#ifndef SIMULATION
+		// Someone has to keep feeding the drives' watchdogs once the cooks stop
+		motorController.setKeepAlive(cookOnDemand);
+#endif // !SIMULATION
+	}
+
+	// Cooks every frame while viewed, or on demand only while something is still going on;
+	// an idle rig then cooks again when an input or parameter changes
+	ginfo->cookEveryFrameIfAsked = !cookOnDemand || !controllerIdle;
 
 	// Note: To disable timeslicing you'll need to turn this off, as well as ensure that
 	// getOutputInfo() returns true, and likely also set the info->numSamples to how many
@@ -106,23 +124,56 @@ MotorControllerCHOP::getGeneralInfo(CHOP_GeneralInfo* ginfo, const OP_Inputs* in
 bool
 MotorControllerCHOP::getOutputInfo(CHOP_OutputInfo* info, const OP_Inputs* inputs, void* reserved1)
 {
+	updateParameters(inputs);
+
+	if (outputChannelsDirty || outputChannelsNodeCount != nodeCount)
+		buildOutputChannels();
+
+	info->numChannels = (int32_t)outputChannels.size();
+	info->numSamples = 1;
+	info->startIndex = 0;
 	return true;
 }
 
 void
 MotorControllerCHOP::getChannelName(int32_t index, OP_String *name, const OP_Inputs* inputs, void* reserved1)
 {
-	name->setString("chan1");
+	if (index >= 0 && index < (int32_t)outputChannels.size())
+		name->setString(outputChannels[index].Name.c_str());
 }
 
 void
 MotorControllerCHOP::execute(CHOP_Output* output,
 							  const OP_Inputs* inputs,
 							  void* reserved)
-{	
-	updateNodeCount();
-	updateMotorCommands(inputs);
-	sendMotorCommands(inputs);
+{
+	cookStartMsec = hostTimeMsec();
+
+	// Nothing may unwind into TouchDesigner, bus failures are already reported by the controller
+	try
+	{
+		updateNodeCount();
+		updateThermal();
+		updateMotorCommands(inputs);
+		bridgeFrameGaps(inputs);
+		filterMotorCommands(inputs);
+		clampMotorCommands(inputs);
+		coordinateMotorCommands(inputs);
+		sendMotorCommands(inputs);
+		alignTelemetry();
+	}
+	catch (std::exception& e)
+	{
+		controllerEvents.push(EVENT_NO_NODE, MN_ERR_FAIL, OP_COOK, hostTimeMsec(), e.what());
+	}
+	catch (...)
+	{
+		controllerEvents.push(EVENT_NO_NODE, MN_ERR_FAIL, OP_COOK, hostTimeMsec(), "Unknown exception during cook");
+	}
+
+	drainControllerEvents();
+	updateIdle();
+	writeOutputChannels(output);
 }
 
 int32_t
@@ -133,124 +184,1737 @@ MotorControllerCHOP::getNumInfoCHOPChans(void * reserved1)
 	return 2;
 }
 
-void
-MotorControllerCHOP::getInfoCHOPChan(int32_t index,
-										OP_InfoCHOPChan* chan,
-										void* reserved1)
+void
+MotorControllerCHOP::getInfoCHOPChan(int32_t index,
+										OP_InfoCHOPChan* chan,
+										void* reserved1)
+{
+	// This function will be called once for each channel we said we'd want to return
+	// In this example it'll only be called once.
+}
+
+bool		
+MotorControllerCHOP::getInfoDATSize(OP_InfoDATSize* infoSize, void* reserved1)
+{
+	infoSize->rows = 1 + MAX_NODES + 1 + 1 + MAX_NODES + 1 + RECENT_EVENT_COUNT + RECENT_NOTICE_COUNT;
+	infoSize->cols = 10;
+	// Setting this to false means we'll be assigning values to the table
+	// one row at a time. True means we'll do it one column at a time.
+	infoSize->byColumn = false;
+	return true;
+}
+
+void
+MotorControllerCHOP::getInfoDATEntries(int32_t index,
+										int32_t nEntries,
+										OP_InfoDATEntries* entries, 
+										void* reserved1)
+{
+	const int32_t debugRow = 1 + MAX_NODES;
+	const int32_t auditHeaderRow = debugRow + 1;
+	const int32_t eventHeaderRow = auditHeaderRow + 1 + MAX_NODES;
+	const int32_t noticeRow = eventHeaderRow + 1 + RECENT_EVENT_COUNT;
+
+	if (index == 0)
+		fillNodeHeader(entries);
+
+	if (index > 0 && index < debugRow)
+		fillNodeInfo(entries, index - 1);
+
+	if (index == debugRow)
+		fillDebugInfo(entries);
+
+	if (index == auditHeaderRow)
+		fillAuditHeader(entries);
+
+	if (index > auditHeaderRow && index < eventHeaderRow)
+		fillAuditInfo(entries, index - auditHeaderRow - 1);
+
+	if (index == eventHeaderRow)
+		fillEventHeader(entries);
+
+	if (index > eventHeaderRow && index < noticeRow)
+		fillEventInfo(entries, recentEvents, RECENT_EVENT_COUNT, recentEventCount, index - eventHeaderRow - 1);
+
+	if (index >= noticeRow)
+		fillEventInfo(entries, recentNotices, RECENT_NOTICE_COUNT, recentNoticeCount, index - noticeRow);
+}
+
+void
+MotorControllerCHOP::setupParameters(OP_ParameterManager* manager, void *reserved1)
+{
+	// One input per axis, or every axis on a single input
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Inputmode";
+		sp.label = "Input Mode";
+		sp.page = "Controller";
+		sp.defaultValue = "Peraxis";
+
+		const char* names[INPUT_MODE_COUNT] = { "Peraxis", "Wide" };
+		const char* labels[INPUT_MODE_COUNT] = { "One CHOP per Axis", "Single CHOP by Channel Name" };
+
+		OP_ParAppendResult res = manager->appendMenu(sp, INPUT_MODE_COUNT, names, labels);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Optional table of channel, axis, field rows that replaces name matching
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Mapping";
+		sp.label = "Channel Mapping DAT";
+		sp.page = "Controller";
+
+		OP_ParAppendResult res = manager->appendDAT(sp);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Latency compensation
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Latencycomp";
+		np.label = "Latency Compensation";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Command-to-motion latency probe
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Latencyprobe";
+		np.label = "Latency Probe";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Network watchdog, drives ramp to a stop when the host stops talking to them this long
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Watchdog";
+		np.label = "Network Watchdog (ms)";
+		np.page = "Controller";
+		np.defaultValues[0] = NET_WATCHDOG_MSEC;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 2000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// In-drive motion audit of every completed move
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Audit";
+		sp.label = "Motion Audit";
+		sp.page = "Controller";
+		sp.defaultValue = "Off";
+
+		const char* names[AUDIT_MODE_COUNT] = { "Off", "Tracking", "Torquemeasured", "Torquecommanded" };
+		const char* labels[AUDIT_MODE_COUNT] = { "Off", "Tracking Error", "Measured Torque", "Commanded Torque" };
+
+		OP_ParAppendResult res = manager->appendMenu(sp, AUDIT_MODE_COUNT, names, labels);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Stop cooking every frame while the inputs are static and the motors idle
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Cookondemand";
+		np.label = "Cook on Demand";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Dropped TouchDesigner frames leave a position jump on the input
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Framegap";
+		sp.label = "Frame Drop Handling";
+		sp.page = "Controller";
+		sp.defaultValue = "Off";
+
+		const char* names[FRAME_GAP_MODE_COUNT] = { "Off", "Interpolate", "Rescale" };
+		const char* labels[FRAME_GAP_MODE_COUNT] = { "Off", "Interpolate Missed Frames", "Rescale Velocity" };
+
+		OP_ParAppendResult res = manager->appendMenu(sp, FRAME_GAP_MODE_COUNT, names, labels);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Position capture on input A
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Capture";
+		np.label = "Position Capture";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Thermal and power budget
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Thermalmonitor";
+		np.label = "Thermal Monitor";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Derate acceleration ahead of an RMS shutdown
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Thermalderate";
+		np.label = "Thermal Derating";
+		np.page = "Controller";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Rate of full bus cycles, cooks in between only refresh the outputs
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Buscyclerate";
+		np.label = "Bus Cycle Rate (Hz)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 240.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// How often the supervisor looks for topology changes
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Supervisorpoll";
+		np.label = "Supervisor Poll (ms)";
+		np.page = "Runtime";
+		np.defaultValues[0] = TOPOLOGY_POLL_MSEC;
+		np.minSliders[0] = 10.0;
+		np.maxSliders[0] = 2000.0;
+		np.minValues[0] = 1.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Telemetry fields, position is always read
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Readvelocity";
+		np.label = "Read Velocity";
+		np.page = "Runtime";
+		np.defaultValues[0] = 1.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Readtorque";
+		np.label = "Read Torque";
+		np.page = "Runtime";
+		np.defaultValues[0] = 1.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Position changes up to this size are not sent
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Deadband";
+		np.label = "Command Deadband";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 100.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Smoothing of noisy position inputs
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Filter";
+		sp.label = "Input Filter";
+		sp.page = "Runtime";
+		sp.defaultValue = "Off";
+
+		const char* names[FILTER_MODE_COUNT] = { "Off", "Lowpass", "Oneeuro" };
+		const char* labels[FILTER_MODE_COUNT] = { "Off", "Low Pass", "One Euro" };
+
+		OP_ParAppendResult res = manager->appendMenu(sp, FILTER_MODE_COUNT, names, labels);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Filtercutoff";
+		np.label = "Filter Cutoff (Hz)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 1.0;
+		np.minSliders[0] = 0.01;
+		np.maxSliders[0] = 30.0;
+		np.minValues[0] = 0.001;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Filterbeta";
+		np.label = "One Euro Beta";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 1.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Travel past the held target, in input units, before it follows the input again
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Hysteresis";
+		np.label = "Hysteresis";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 10.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Slewlimit";
+		np.label = "Slew Limit (units/s)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 10000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Sync mode, axes of one group share the duration of their slowest move
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Coordinate";
+		np.label = "Coordinated Moves";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Table of axis, mode rows
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Axismodes";
+		sp.label = "Axis Control Modes DAT";
+		sp.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendDAT(sp);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Table of axis, time, position and optional velocity rows, played back on the host
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Keyframes";
+		sp.label = "Keyframes DAT";
+		sp.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendDAT(sp);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Loopkeyframes";
+		np.label = "Loop Keyframes";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+
+		OP_ParAppendResult res = manager->appendToggle(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Playkeyframes";
+		np.label = "Play Keyframes";
+		np.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendPulse(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Limits for inputs that carry no velocity or acceleration
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Defaultvel";
+		np.label = "Default Velocity (rpm)";
+		np.page = "Runtime";
+		np.defaultValues[0] = DEFAULT_VEL_LIM_RPM;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 4000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Defaultacc";
+		np.label = "Default Acceleration (rpm/s)";
+		np.page = "Runtime";
+		np.defaultValues[0] = DEFAULT_ACC_LIM_RPM_PER_SEC;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 200000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Move shape for inputs that carry no profile channels, asymmetric and head-tail need Advanced nodes
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Moveprofile";
+		sp.label = "Move Profile";
+		sp.page = "Runtime";
+		sp.defaultValue = "Trapezoid";
+
+		const char* names[MOVE_PROFILE_COUNT] = { "Trapezoid", "Asymmetric", "Headtail" };
+		const char* labels[MOVE_PROFILE_COUNT] = { "Trapezoid", "Asymmetric", "Head and Tail" };
+
+		OP_ParAppendResult res = manager->appendMenu(sp, MOVE_PROFILE_COUNT, names, labels);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Defaultdec";
+		np.label = "Default Deceleration (rpm/s)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 200000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Jerklimit";
+		np.label = "Jerk Limit (-1 keeps drive)";
+		np.page = "Runtime";
+		np.defaultValues[0] = JERK_LIMIT_UNSET;
+		np.minSliders[0] = JERK_LIMIT_UNSET;
+		np.maxSliders[0] = 10.0;
+		np.minValues[0] = JERK_LIMIT_UNSET;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendInt(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Headdistance";
+		np.label = "Head Distance (units)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 100.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Taildistance";
+		np.label = "Tail Distance (units)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 100.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Headtailvel";
+		np.label = "Head and Tail Velocity (rpm)";
+		np.page = "Runtime";
+		np.defaultValues[0] = 0.0;
+		np.minSliders[0] = 0.0;
+		np.maxSliders[0] = 4000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Homingtimeout";
+		np.label = "Homing Timeout (ms)";
+		np.page = "Runtime";
+		np.defaultValues[0] = DEFAULT_TIME_TILL_TIMEOUT;
+		np.minSliders[0] = 1000.0;
+		np.maxSliders[0] = 60000.0;
+		np.minValues[0] = 0.0;
+		np.clampMins[0] = true;
+
+		OP_ParAppendResult res = manager->appendFloat(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	// Node profiles, warm start cache and drive configurations; read once, when the controller starts
+	{
+		OP_StringParameter	sp;
+
+		sp.name = "Statefolder";
+		sp.label = "State Folder";
+		sp.page = "Runtime";
+		sp.defaultValue = "";
+
+		OP_ParAppendResult res = manager->appendFolder(sp);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Home";
+		np.label = "Home";
+		np.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendPulse(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Reconnect";
+		np.label = "Reconnect";
+		np.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendPulse(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+
+	{
+		OP_NumericParameter	np;
+
+		np.name = "Stop";
+		np.label = "Stop";
+		np.page = "Runtime";
+
+		OP_ParAppendResult res = manager->appendPulse(np);
+		assert(res == OP_ParAppendResult::Success);
+	}
+}
+
+void 
+MotorControllerCHOP::pulsePressed(const char* name, void* reserved1)
+{
+	// Starts from the first keyframe, on the same clock the cook evaluates the trajectory with
+	if (strcmp(name, "Playkeyframes") == 0)
+		trajectory.play(hostTimeMsec() / 1000.0, loopKeyframes);
+
+#ifndef SIMULATION
+	// Homing and reconnecting take seconds, the supervisor does them; a stop goes out right away
+	if (strcmp(name, "Stop") == 0)
+	{
+		motorStopped = true;
+		motorController.stopAll();
+		trajectory.stop();
+	}
+	else if (strcmp(name, "Home") == 0)
+	{
+		motorStopped = false;
+		motorController.requestHoming();
+	}
+	else if (strcmp(name, "Reconnect") == 0)
+	{
+		motorStopped = false;
+		motorController.requestReconnect();
+	}
+#endif // !SIMULATION
+}
+
+double MotorControllerCHOP::hostTimeMsec()
+{
+#ifndef SIMULATION
+	return motorController.timeStampMsec();
+#else
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+#endif // !SIMULATION
+}
+
+void MotorControllerCHOP::updateParameters(const OP_Inputs* inputs)
+{
+	int input = inputs->getParInt("Inputmode");
+	inputMode = input > INPUT_PER_AXIS && input < INPUT_MODE_COUNT ? (InputMode)input : INPUT_PER_AXIS;
+
+	bool compensation = inputs->getParInt("Latencycomp") != 0;
+
+	if (compensation != latencyCompensation)
+	{
+		latencyCompensation = compensation;
+		outputChannelsDirty = true;
+	}
+
+	bool probing = inputs->getParInt("Latencyprobe") != 0;
+
+	if (probing != latencyProbing)
+	{
+		latencyProbing = probing;
+		outputChannelsDirty = true;
+
+		for (int i = 0; i < MAX_NODES; i++)
+			latencyProbes[i].reset();
+	}
+
+	int audit = inputs->getParInt("Audit");
+	AuditMode mode = audit > AUDIT_OFF && audit < AUDIT_MODE_COUNT ? (AuditMode)audit : AUDIT_OFF;
+
+	if (mode != auditMode)
+	{
+		if ((mode != AUDIT_OFF) != (auditMode != AUDIT_OFF))
+			outputChannelsDirty = true;
+
+		auditMode = mode;
+
+		// Statistics of different test points do not mix
+		for (int i = 0; i < MAX_NODES; i++)
+			motorsInfo[i].Audit.reset();
+	}
+
+	int gap = inputs->getParInt("Framegap");
+	frameGapMode = gap > FRAME_GAP_OFF && gap < FRAME_GAP_MODE_COUNT ? (FrameGapMode)gap : FRAME_GAP_OFF;
+
+	bool coordinated = inputs->getParInt("Coordinate") != 0;
+
+	if (coordinated != coordinatedMoves)
+	{
+		coordinatedMoves = coordinated;
+		outputChannelsDirty = true;
+	}
+
+	bool capture = inputs->getParInt("Capture") != 0;
+
+	if (capture != positionCapture)
+	{
+		positionCapture = capture;
+		outputChannelsDirty = true;
+	}
+
+	bool monitoring = inputs->getParInt("Thermalmonitor") != 0;
+
+	if (monitoring != thermalMonitoring)
+	{
+		thermalMonitoring = monitoring;
+		outputChannelsDirty = true;
+
+#ifndef SIMULATION
+		motorController.setThermalMonitoring(thermalMonitoring);
+#endif // !SIMULATION
+	}
+
+	thermalDerating = thermalMonitoring && inputs->getParInt("Thermalderate") != 0;
+
+	double rate = inputs->getParDouble("Buscyclerate");
+	busCycleMsec = rate > 0.0 ? 1000.0 / rate : 0.0;
+
+	readVelocity = inputs->getParInt("Readvelocity") != 0;
+	readTorque = inputs->getParInt("Readtorque") != 0;
+	commandDeadband = inputs->getParDouble("Deadband");
+
+	int filter = inputs->getParInt("Filter");
+	filterSettings.Mode = filter > FILTER_OFF && filter < FILTER_MODE_COUNT ? (FilterMode)filter : FILTER_OFF;
+	filterSettings.MinCutoffHz = inputs->getParDouble("Filtercutoff");
+	filterSettings.Beta = inputs->getParDouble("Filterbeta");
+	filterSettings.HysteresisUnits = inputs->getParDouble("Hysteresis");
+	filterSettings.SlewUnitsPerSec = inputs->getParDouble("Slewlimit");
+	defaultVelRpm = inputs->getParDouble("Defaultvel");
+	defaultAccRpmPerSec = inputs->getParDouble("Defaultacc");
+	defaultProfile[MOVE_FIELD_TYPE] = inputs->getParInt("Moveprofile");
+	defaultProfile[MOVE_FIELD_DEC] = inputs->getParDouble("Defaultdec");
+	defaultProfile[MOVE_FIELD_JERK] = inputs->getParInt("Jerklimit");
+	defaultProfile[MOVE_FIELD_HEAD] = inputs->getParDouble("Headdistance");
+	defaultProfile[MOVE_FIELD_TAIL] = inputs->getParDouble("Taildistance");
+	defaultProfile[MOVE_FIELD_HEAD_TAIL_VEL] = inputs->getParDouble("Headtailvel");
+
+#ifndef SIMULATION
+	motorController.setSupervisorPoll(inputs->getParDouble("Supervisorpoll"));
+	motorController.setHomingTimeout(inputs->getParDouble("Homingtimeout"));
+
+	// Only now is the state folder known, the first cook connects and homes
+	if (!motorController.isStarted())
+		motorController.start(stateFilePrefix(inputs));
+#endif // !SIMULATION
+
+	updateControlModes(inputs);
+
+	trajectory.update(inputs->getParDAT("Keyframes"));
+	loopKeyframes = inputs->getParInt("Loopkeyframes") != 0;
+
+	double watchdogMsec = inputs->getParDouble("Watchdog");
+
+	if (watchdogMsec != netWatchdogMsec)
+	{
+		// Heartbeat channels only exist while the watchdog is armed
+		if ((watchdogMsec > 0.0) != (netWatchdogMsec > 0.0))
+			outputChannelsDirty = true;
+
+		netWatchdogMsec = watchdogMsec;
+
+#ifndef SIMULATION
+		motorController.setNetWatchdog(netWatchdogMsec);
+#endif // !SIMULATION
+	}
+}
+
+void MotorControllerCHOP::updateControlModes(const OP_Inputs* inputs)
+{
+	const OP_DATInput* table = inputs->getParDAT("Axismodes");
+
+	// Only parsed when the table changed, the controller keeps the modes with the node profiles
+	if (!modesTable.changed(table))
+		return;
+
+	if (table == nullptr || !table->isTable || table->numCols < 2)
+		return;
+
+	for (int32_t row = 0; row < table->numRows; row++)
+	{
+		size_t axis;
+		AxisControlMode mode;
+
+		if (!parseAxisCell(table->getCell(row, 0), MAX_NODES, axis) || !parseControlMode(table->getCell(row, 1), mode))
+			continue;
+
+#ifndef SIMULATION
+		motorController.setControlMode(axis, mode);
+#else
+		motorsInfo[axis].ControlMode = mode;
+#endif // !SIMULATION
+	}
+}
+
+std::string MotorControllerCHOP::stateFilePrefix(const OP_Inputs* inputs)
+{
+	// Named after the operator's path, /project1/motors becomes MotorControllerCHOP_project1_motors,
+	// so every operator keeps state of its own
+	std::string prefix = inputs->getParFilePath("Statefolder");
+
+	// Without a folder, the working directory, which TouchDesigner sets to the .toe's folder
+	if (prefix.empty())
+		prefix = ".";
+
+	if (prefix.back() != '/' && prefix.back() != '\\')
+		prefix += '/';
+
+	prefix += "MotorControllerCHOP";
+
+	for (const char* c = myNodeInfo->opPath; *c != '\0'; c++)
+		prefix += isalnum((unsigned char)*c) ? *c : '_';
+
+	return prefix;
+}
+
+void MotorControllerCHOP::updateNodeCount()
+{
+#ifndef SIMULATION
+	// Cached table kept current by the controller's supervisor thread, no bus traffic here
+	std::shared_ptr<const NodeTopology> topology = motorController.getTopology();
+
+	nodeCount = topology->PortState == OPENED_ONLINE ? topology->NodeCount : 0;
+
+	if (topology->Generation != topologyGeneration)
+	{
+		topologyGeneration = topology->Generation;
+
+		for (int i = 0; i < nodeCount && i < MAX_NODES; i++)
+		{
+			if (topology->PositioningResolution[i] > 0)
+				motorsInfo[i].CountsPerRev = topology->PositioningResolution[i];
+
+			commands.setLimits(i, topology->Limits[i], topology->Profile[i].ControlMode == CONTROL_UNBOUNDED);
+			motorsInfo[i].Duration.CountsPerRev = motorsInfo[i].CountsPerRev;
+			motorsInfo[i].Duration.JerkDelayMsec = topology->Limits[i].JerkDelayMsec;
+			motorsInfo[i].Units = topology->Units[i];
+			commands.CountsPerUnit[i] = topology->Units[i].CountsPerUnit;
+			motorsInfo[i].CaptureOnRise = topology->CaptureOnRise[i];
+			motorsInfo[i].ControlMode = topology->Profile[i].ControlMode;
+			motorsInfo[i].IsAdvanced = topology->IsAdvanced[i];
+			commandFilter.reset(i);
+			motorsInfo[i].DriveTriggerGroup = 0;
+
+			// The node on this axis may have changed or power cycled, select the test point again
+			motorsInfo[i].AuditSelected = AUDIT_OFF;
+			motorsInfo[i].WarmStarted = motorController.wasWarmStarted(i);
+		}
+	}
+#else
+	nodeCount = 2;
+#endif // !SIMULATION
+
+	if (nodeCount > MAX_NODES)
+		nodeCount = MAX_NODES;
+}
+
+void MotorControllerCHOP::updateThermal()
+{
+#ifndef SIMULATION
+	// Sampled at low priority by the supervisor, only pick up a new report when there is one
+	std::shared_ptr<const ThermalReport> thermal = motorController.getThermal();
+
+	if (thermal->Sequence != thermalSequence)
+	{
+		thermalSequence = thermal->Sequence;
+
+		for (int i = 0; i < nodeCount; i++)
+			motorsInfo[i].Thermal = thermal->Axis[i];
+	}
+#endif // !SIMULATION
+
+	for (int i = 0; i < nodeCount; i++)
+		commands.AccScale[i] = thermalDerating ? motorsInfo[i].Thermal.derating() : 1.0;
+}
+
+void MotorControllerCHOP::setMotorCommand(int iNode, double pos, double vel, double acc, double group, const double profile[MOVE_FIELD_COUNT])
+{
+	// Converted to counts for every axis at once by convertCommands
+	commands.InputPos[iNode] = pos;
+	commands.CmdVel[iNode] = vel;
+	commands.CmdAcc[iNode] = acc;
+	commands.HasCommand[iNode] = 1;
+
+	group = std::round(group);
+	group = group < 0.0 ? 0.0 : (group > COORD_GROUP_MAX ? COORD_GROUP_MAX : group);
+
+	motorsInfo[iNode].Group = (int32_t)group;
+
+	// Resolved against the node and its limits right before the moves go out
+	motorsInfo[iNode].Profile = makeMoveProfile(profile, commands.CountsPerUnit[iNode]);
+}
+
+void MotorControllerCHOP::updateMotorCommand(const OP_Inputs* inputs, int iNode)
+{
+	const OP_CHOPInput* input = inputs->getInputCHOP(iNode);
+
+	commands.HasCommand[iNode] = 0;
+
+	if (input != nullptr && input->numChannels >= 1 && input->numSamples > 0)
+	{
+		// Channels after the position are optional: velocity, acceleration, then the group (default 1),
+		// then the move profile fields in MoveProfileField order
+		double vel = input->numChannels >= 2 ? input->channelData[1][0] : defaultVelRpm;
+		double acc = input->numChannels >= 3 ? input->channelData[2][0] : defaultAccRpmPerSec;
+		double group = input->numChannels >= 4 ? input->channelData[3][0] : 1.0;
+		double profile[MOVE_FIELD_COUNT];
+
+		for (int k = 0; k < MOVE_FIELD_COUNT; k++)
+			profile[k] = input->numChannels > INPUT_PROFILE + k ? input->channelData[INPUT_PROFILE + k][0] : defaultProfile[k];
+
+		setMotorCommand(iNode, input->channelData[0][0], vel, acc, group, profile);
+	}
+}
+
+void MotorControllerCHOP::updateMotorCommand(const OP_CHOPInput* input, int iNode)
+{
+	commands.HasCommand[iNode] = 0;
+
+	if (!inputMapping.hasPosition(iNode))
+		return;
+
+	int32_t velChannel = inputMapping.channel(iNode, INPUT_VEL);
+	int32_t accChannel = inputMapping.channel(iNode, INPUT_ACC);
+	int32_t groupChannel = inputMapping.channel(iNode, INPUT_GROUP);
+	double profile[MOVE_FIELD_COUNT];
+
+	for (int k = 0; k < MOVE_FIELD_COUNT; k++)
+	{
+		int32_t channel = inputMapping.channel(iNode, (InputField)(INPUT_PROFILE + k));
+		profile[k] = channel >= 0 ? input->channelData[channel][0] : defaultProfile[k];
+	}
+
+	setMotorCommand(iNode,
+		input->channelData[inputMapping.channel(iNode, INPUT_POS)][0],
+		velChannel >= 0 ? input->channelData[velChannel][0] : defaultVelRpm,
+		accChannel >= 0 ? input->channelData[accChannel][0] : defaultAccRpmPerSec,
+		groupChannel >= 0 ? input->channelData[groupChannel][0] : 1.0,
+		profile);
+}
+
+void MotorControllerCHOP::updateMotorCommands(const OP_Inputs* inputs)
+{
+	auto numInput = inputs->getNumInputs();
+
+	if (inputMode == INPUT_WIDE)
+	{
+		const OP_CHOPInput* input = numInput > 0 ? inputs->getInputCHOP(0) : nullptr;
+
+		// Channel names are only matched again when the layout or the table changed
+		inputMapping.update(input, inputs->getParDAT("Mapping"));
+
+		int mapped = input != nullptr && input->numSamples > 0 ? (int)inputMapping.axisCount() : 0;
+		inputAxisCount = (mapped < nodeCount) ? mapped : nodeCount;
+
+		for (int i = 0; i < inputAxisCount; i++)
+		{
+			updateMotorCommand(input, i);
+		}
+	}
+	else
+	{
+		inputAxisCount = (numInput < nodeCount) ? numInput : nodeCount;
+
+		for (int i = 0; i < inputAxisCount; i++)
+		{
+			updateMotorCommand(inputs, i);
+		}
+	}
+
+	updateKeyframedCommands(inputs);
+
+	convertCommands(commands, inputAxisCount);
+}
+
+void MotorControllerCHOP::updateKeyframedCommands(const OP_Inputs* inputs)
+{
+	int keyedAxisCount = (int)trajectory.axisCount() < nodeCount ? (int)trajectory.axisCount() : nodeCount;
+
+	if (keyedAxisCount <= 0)
+		return;
+
+	// Every axis at once, on the host clock: the network upstream does not have to resample anything per frame
+	const double* setpoint = trajectory.evaluate(cookStartMsec / 1000.0);
+	const double* velocity = trajectory.velocity();
+	bool playing = trajectory.isPlaying();
+
+	// A step has until the next bus cycle to get where it is going
+	const OP_TimeInfo* time = inputs->getTimeInfo();
+	double cycleSec = busCycleMsec > 0.0 ? busCycleMsec / 1000.0 : (time != nullptr && time->rate > 0.0 ? 1.0 / time->rate : 0.0);
+
+	for (int i = inputAxisCount; i < keyedAxisCount; i++)
+		commands.HasCommand[i] = 0;
+
+	if (keyedAxisCount > inputAxisCount)
+		inputAxisCount = keyedAxisCount;
+
+	for (int i = 0; i < keyedAxisCount; i++)
+	{
+		if (!trajectory.hasKeys(i))
+			continue;
+
+		// Held, or with nothing sent to step from, the axis gets to its setpoint at the default velocity
+		double velRpm = defaultVelRpm;
+
+		// Playing, a step covers the curve's travel over one cycle, or the jump to the setpoint when that is
+		// further, as at the start or a loop wrap; see KeyframeTrajectory. Clamped to the node's limits later.
+		if (playing && commands.SentValid[i] && cycleSec > 0.0)
+		{
+			double curveCnts = std::fabs(velocity[i] * commands.CountsPerUnit[i]) * cycleSec;
+			double stepCnts = std::fabs(setpoint[i] * commands.CountsPerUnit[i] - commands.SentPos[i]);
+			double cntsPerSec = (curveCnts > stepCnts ? curveCnts : stepCnts) / cycleSec;
+
+			velRpm = cntsPerSec * 60.0 / motorsInfo[i].CountsPerRev * KEYFRAME_VEL_HEADROOM;
+		}
+
+		setMotorCommand(i, setpoint[i], velRpm, defaultAccRpmPerSec, 1.0, defaultProfile);
+	}
+}
+
+void MotorControllerCHOP::bridgeFrameGaps(const OP_Inputs* inputs)
+{
+	const OP_TimeInfo* time = inputs->getTimeInfo();
+
+	// The previous cook ended idle under Cook on Demand, deltaFrames counts the whole pause since
+	if (cookOnDemand && controllerIdle)
+		frameGaps.restart();
+
+	bool gap = time != nullptr && frameGaps.update(time->absFrame, time->deltaFrames, time->deltaMS);
+	double frames = frameGaps.DeltaFrames < FRAME_GAP_MAX_BRIDGE ? frameGaps.DeltaFrames : FRAME_GAP_MAX_BRIDGE;
+	double frameMsec = time != nullptr && time->rate > 0.0 ? 1000.0 / time->rate : 0.0;
+
+	size_t availableNode = inputAxisCount;
+
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		MotorInfo& info = motorsInfo[i];
+
+		commands.VelCap[i] = 0.0;
+
+		if (frameGapMode != FRAME_GAP_INTERPOLATE)
+			info.GapOffsetCnts = 0.0;
+
+		// What is still held back from an earlier gap is released one step per cook
+		if (std::fabs(info.GapOffsetCnts) <= info.GapStepCnts)
+			info.GapOffsetCnts = 0.0;
+		else
+			info.GapOffsetCnts -= info.GapOffsetCnts > 0.0 ? info.GapStepCnts : -info.GapStepCnts;
+
+		if (!gap || frameGapMode == FRAME_GAP_OFF || !commands.CommandChanged[i])
+			continue;
+
+		double jump = commands.CmpPos[i] - commands.PrevCmpPos[i];
+
+		if (frameGapMode == FRAME_GAP_INTERPOLATE)
+		{
+			// Motion continues at the input's pace and catches up over as many frames as were missed
+			info.GapOffsetCnts += jump * (frames - 1.0) / frames;
+			info.GapStepCnts = std::fabs(info.GapOffsetCnts) / (frames - 1.0);
+		}
+		else if (frameMsec > 0.0)
+		{
+			double cntsPerMsec = std::fabs(jump) / (frames * frameMsec);
+
+			commands.VelCap[i] = cntsPerMsec * 60000.0 / info.CountsPerRev * FRAME_GAP_VEL_HEADROOM;
+		}
+	}
+}
+
+void MotorControllerCHOP::filterMotorCommands(const OP_Inputs* inputs)
 {
-	// This function will be called once for each channel we said we'd want to return
-	// In this example it'll only be called once.
+	size_t availableNode = inputAxisCount;
+
+	double dtMsec = lastFilterMsec > 0.0 ? cookStartMsec - lastFilterMsec : 0.0;
+	lastFilterMsec = cookStartMsec;
+
+	for (size_t i = 0; i < availableNode; i++)
+		commands.RawPos[i] = commands.CmpPos[i] - motorsInfo[i].GapOffsetCnts;
+
+	commandFilter.run(availableNode, commands.RawPos, commands.CountsPerUnit, commands.HasCommand, dtMsec,
+		filterSettings, commands.FilteredPos);
 }
 
-bool		
-MotorControllerCHOP::getInfoDATSize(OP_InfoDATSize* infoSize, void* reserved1)
+void MotorControllerCHOP::clampMotorCommands(const OP_Inputs* inputs)
 {
-	infoSize->rows = 18;
-	infoSize->cols = 9;
-	// Setting this to false means we'll be assigning values to the table
-	// one row at a time. True means we'll do it one column at a time.
-	infoSize->byColumn = false;
-	return true;
+	size_t availableNode = inputAxisCount;
+
+	// Validate every command locally before any of them reaches the bus
+	clampTotal += clampCommands(commands, availableNode);
+
+	for (size_t i = 0; i < availableNode; i++)
+		motorsInfo[i].ClampCount += commands.Clamped[i] != CLAMP_NONE;
+
+	diffPositions(commands, availableNode, commandDeadband);
 }
 
-void
-MotorControllerCHOP::getInfoDATEntries(int32_t index,
-										int32_t nEntries,
-										OP_InfoDATEntries* entries, 
-										void* reserved1)
+void MotorControllerCHOP::coordinateMotorCommands(const OP_Inputs* inputs)
 {
-	char tempBuffer[4096];
+	if (!coordinatedMoves)
+		return;
 
-	if (index == 0)
-		fillNodeHeader(entries);
+	size_t availableNode = inputAxisCount;
 
-	if (index > 0 && index < 17)
-		fillNodeInfo(entries, index - 1);
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		const MotorInfo& info = motorsInfo[i];
 
-	if (index == 17)
-		fillDebugInfo(entries);
+		// Only a new position joins the group; an axis holding its target keeps the limits it was sent with,
+		// otherwise a change of CmdVel alone would queue another move
+		bool moving = commands.HasCommand[i] && commands.TargetValid[i] && commands.PosChanged[i];
+
+		if (!moving && commands.SentValid[i])
+		{
+			commands.TargetVel[i] = commands.SentVel[i];
+			commands.TargetAcc[i] = commands.SentAcc[i];
+		}
+
+		// A queued move starts where the previous one ends
+		bool queued = commands.SentValid[i] && info.ArrivalMsec > cookStartMsec;
+		double fromPos = queued ? commands.SentPos[i] : info.MeasuredPos;
+
+		coordGroup[i] = moving ? info.Group : 0;
+		coordDistance[i] = commands.TargetPos[i] - fromPos;
+		coordCountsPerRev[i] = info.CountsPerRev;
+		coordVel[i] = commands.TargetVel[i];
+		coordAcc[i] = commands.TargetAcc[i];
+	}
+
+	coordinateGroups(availableNode, coordGroup, coordDistance, coordCountsPerRev, coordVel, coordAcc, groupDurationMsec);
+
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		if (coordGroup[i] == 0)
+			continue;
+
+		// Scaling only ever slows an axis down, so the clamped maximums still hold
+		commands.TargetVel[i] = coordVel[i] > VEL_LIM_MIN_RPM ? coordVel[i] : VEL_LIM_MIN_RPM;
+		commands.TargetAcc[i] = coordAcc[i] > ACC_LIM_MIN_RPM_PER_SEC ? coordAcc[i] : ACC_LIM_MIN_RPM_PER_SEC;
+		motorsInfo[i].GroupDurationMsec = groupDurationMsec[coordGroup[i]];
+	}
 }
 
-void
-MotorControllerCHOP::setupParameters(OP_ParameterManager* manager, void *reserved1)
+void MotorControllerCHOP::sendMotorCommand(int iNode)
 {
+#ifndef SIMULATION
+	NodeTransaction& transaction = motorTransactions[iNode];
+	const MotorInfo& cmd = motorsInfo[iNode];
+
+	transaction = NodeTransaction();
+
+	transaction.ReadStatus = true;
+	transaction.ReadTelemetry = true;
+
+	// PosnCommanded costs an extra round trip and is only needed to find the planning onset
+	transaction.WithCommanded = latencyProbing;
+
+	// The capture registers are Advanced only, reading them on a standard node throws
+	transaction.ReadCapture = positionCapture && cmd.IsAdvanced;
+	transaction.CaptureOnRise = cmd.CaptureOnRise;
+
+	if (auditMode != AUDIT_OFF && cmd.IsAdvanced)
+	{
+		transaction.SelectAudit = cmd.AuditSelected != auditMode ? auditMode : AUDIT_OFF;
+		transaction.ReadAudit = true;
+	}
+
+	transaction.ReadVelocity = readVelocity;
+	transaction.ReadTorque = readTorque;
+
+	bool held = motorStopped || controllerHoming;
+
+	if (commands.Suppressed[iNode])
+	{
+		motorsInfo[iNode].SuppressedCount++;
+		movesSuppressed++;
+	}
+
+	// Every MovePosnStart queues a move on the drive, so an unchanged target is not sent again
+	if (isNodeAvailable(iNode) && commands.HasCommand[iNode] && commands.TargetValid[iNode] && commands.Changed[iNode] && !held)
+	{
+		transaction.StartMove = true;
+		transaction.MoveVirtual = true;
+		transaction.VirtualTargetCnts = std::llround(commands.TargetPos[iNode]);
+		transaction.VelLimit = commands.TargetVel[iNode];
+		transaction.AccLimit = commands.TargetAcc[iNode];
+		transaction.Profile = cmd.Profile;
+
+		// Checked from rest only, where the model and the drive start from the same position
+		transaction.QueryDuration = cmd.Duration.wantsVerification() && cmd.ArrivalMsec <= cookStartMsec;
+
+		// Loaded now and started by one broadcast once every axis of the group has its move
+		if (coordinatedMoves && cmd.Group > 0 && cmd.IsAdvanced)
+		{
+			transaction.Triggered = true;
+			transaction.TriggerGroup = cmd.DriveTriggerGroup != cmd.Group ? cmd.Group : 0;
+			triggeredGroups |= 1u << cmd.Group;
+		}
+	}
+#endif // !SIMULATION
 }
 
-void 
-MotorControllerCHOP::pulsePressed(const char* name, void* reserved1)
+void MotorControllerCHOP::sendMotorCommands(const OP_Inputs* inputs)
 {
+	size_t availableNode = inputAxisCount;
+
+	// Below the bus cycle rate a cook only refreshes its outputs
+	if (busCycleMsec > 0.0 && cookStartMsec - lastBusCycleMsec < busCycleMsec)
+		return;
+
+	lastBusCycleMsec = cookStartMsec;
+
+#ifndef SIMULATION
+	bool homing = motorController.isHoming();
+
+	// Homing moved every axis, whatever was sent before no longer holds
+	if (controllerHoming && !homing)
+	{
+		for (int i = 0; i < MAX_NODES; i++)
+			commands.SentValid[i] = 0;
+	}
+
+	controllerHoming = homing;
+#endif // !SIMULATION
+
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		MotorInfo& info = motorsInfo[i];
+
+		if (!commands.HasCommand[i])
+			continue;
+
+		// Coordination scales a symmetric trapezoid; a separate deceleration or a slow head and tail would not
+		// stretch with it and the group would no longer arrive together
+		if (coordinatedMoves && info.Group > 0)
+			info.Profile.Type = MOVE_TRAPEZOID;
+
+		info.Profile = resolveMoveProfile(info.Profile, info.IsAdvanced, commands.TargetAcc[i], commands.AccScale[i],
+			commands.AccMax[i], commands.VelMax[i]);
+
+		// Sent again like a changed limit, the drive only learns the new shape with a move
+		if (info.Profile != info.SentProfile)
+			commands.SentValid[i] = 0;
+	}
+
+	diffCommands(commands, availableNode);
+
+	triggeredGroups = 0;
+
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		sendMotorCommand(i);
+	}
+
+#ifndef SIMULATION
+	// Axes without an input still need to hear from the host or their watchdog stops them
+	for (int i = (int)availableNode; i < nodeCount; i++)
+	{
+		motorTransactions[i] = NodeTransaction();
+		motorTransactions[i].Heartbeat = true;
+	}
+
+	motorController.transactAll(motorTransactions, nodeCount);
+	triggerMotorCommands();
+
+	for (int i = 0; i < nodeCount; i++)
+		motorsInfo[i].Heartbeat = motorController.getHeartbeat(i);
+#endif // !SIMULATION
+
+	for (size_t i = 0; i < availableNode; i++)
+	{
+		updateMotorState(i);
+	}
 }
 
-void MotorControllerCHOP::updateNodeCount()
+void MotorControllerCHOP::triggerMotorCommands()
 {
 #ifndef SIMULATION
-	nodeCount = motorController.getNodeCount();
-#else
-	nodeCount = 2;
+	if (triggeredGroups == 0)
+		return;
+
+	for (size_t g = 1; g <= COORD_GROUP_MAX; g++)
+	{
+		if (triggeredGroups & (1u << g))
+			motorController.triggerGroup(g);
+	}
+
+	// The loaded moves start now rather than when each was sent
+	double triggerMsec = hostTimeMsec();
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		if (motorTransactions[i].Triggered)
+			motorTransactions[i].MoveSentMsec = triggerMsec;
+	}
 #endif // !SIMULATION
 }
 
-void MotorControllerCHOP::updateMotorCommand(const OP_Inputs* inputs, int iNode)
+void MotorControllerCHOP::updateMotorState(int iNode)
 {
-	motorsInfo[iNode].CmpPos = inputs->getInputCHOP(iNode)->channelData[0][0];
-	motorsInfo[iNode].CmdVel = inputs->getInputCHOP(iNode)->channelData[1][0];
-	motorsInfo[iNode].CmdAcc = inputs->getInputCHOP(iNode)->channelData[2][0];
-
 #ifndef SIMULATION
-	motorsInfo[iNode].IsEnable		= motorController.enableMotor(iNode);
+	const NodeTransaction& transaction = motorTransactions[iNode];
+	MotorInfo& info = motorsInfo[iNode];
+
+	// On failure the previous values are kept and the error is already queued; a node being homed reports BUSY
+	if (transaction.Result != Status::SUCCESS)
+	{
+		commands.SentValid[iNode] = 0;
+		return;
+	}
+
+	info.StatusFlags.update(transaction.Status);
+	info.IsEnable = info.StatusFlags.is(STATUS_ENABLED);
+
+	// A new jerk limit changes the S-curve every later move carries
+	if (transaction.JerkDelayMsec >= 0.0)
+		info.Duration.JerkDelayMsec = transaction.JerkDelayMsec;
+
+	if (transaction.StartMove)
+	{
+		predictArrival(iNode);
+
+		commands.SentPos[iNode] = (double)transaction.VirtualTargetCnts;
+		commands.SentVel[iNode] = transaction.VelLimit;
+		commands.SentAcc[iNode] = transaction.AccLimit;
+		commands.SentValid[iNode] = 1;
+		info.SentProfile = transaction.Profile;
+		movesSent++;
+
+		if (transaction.TriggerGroup > 0)
+			info.DriveTriggerGroup = transaction.TriggerGroup;
+	}
+
+	// A node that was disabled lost its move, send the target again once it is back
+	if (transaction.Status.Rise & (1u << statusFieldShift[STATUS_ENABLED]))
+		commands.SentValid[iNode] = 0;
+
+	// So did one its watchdog stopped, unless this cycle already sent it again
+	if (transaction.WatchdogTripped && !transaction.StartMove)
+		commands.SentValid[iNode] = 0;
+
+	if (transaction.SelectAudit != AUDIT_OFF)
+		info.AuditSelected = transaction.SelectAudit;
+
+	if (transaction.Audited)
+	{
+		AuditRecord record = transaction.Audit;
+		record.Mode = info.AuditSelected;
+		info.Audit.push(record);
+	}
+
+	// Needs the previous sample, so before it is overwritten
+	if (transaction.Captured)
+		latchCapture(iNode);
+
+	const TelemetrySample& sample = transaction.Telemetry;
+
+	info.MeasuredPos		= sample.Pos;
+	info.MeasuredVel		= sample.Vel;
+	info.MeasuredTrq		= sample.Trq;
+	info.MeasuredTimeMsec	= sample.TimeMsec;
 
-	motorsInfo[iNode].MeasuredPos	= motorController.getMeasuredPos(iNode);
-	motorsInfo[iNode].MeasuredVel	= motorController.getMeasuredVel(iNode);
-	motorsInfo[iNode].MeasuredTrq	= motorController.getMeasuredTrq(iNode);
+	if (latencyProbing)
+	{
+		info.CommandedPos = sample.Commanded;
+		latencyProbes[iNode].sample(sample.TimeMsec, sample.Commanded, sample.Pos);
+
+		// Only a new target on an axis at rest gives a clean onset to measure
+		if (transaction.StartMove && commands.CommandChanged[iNode] && !latencyProbes[iNode].isArmed()
+			&& std::fabs(sample.Vel) < LATENCY_REST_RPM)
+		{
+			double accCntsPerMsec2 = transaction.AccLimit * info.CountsPerRev / 60.0 / 1.0e6;
+
+			latencyProbes[iNode].arm(cookStartMsec, transaction.MoveStartMsec, transaction.MoveSentMsec,
+				sample.Commanded, sample.Pos, accCntsPerMsec2);
+		}
+	}
 #else
 	motorsInfo[iNode].IsEnable		= false;
 
 	motorsInfo[iNode].MeasuredPos	= 0.0;
 	motorsInfo[iNode].MeasuredVel	= 0.0;
 	motorsInfo[iNode].MeasuredTrq	= 0.0;
+	motorsInfo[iNode].MeasuredTimeMsec = hostTimeMsec();
 #endif // !SIMULATION
 }
 
-void MotorControllerCHOP::updateMotorCommands(const OP_Inputs* inputs)
+void MotorControllerCHOP::predictArrival(int iNode)
 {
-	size_t availableNode = 0;
-	auto numInput = inputs->getNumInputs();
+#ifndef SIMULATION
+	const NodeTransaction& transaction = motorTransactions[iNode];
+	MotorInfo& info = motorsInfo[iNode];
 
-	availableNode = (numInput < nodeCount) ? numInput : nodeCount;
-	
-	for (size_t i = 0; i < availableNode; i++)
+	double sentMsec = transaction.MoveSentMsec;
+
+	if (info.ArrivalMsec <= sentMsec)
+		info.PendingMoves = 0;
+
+	// A queued move starts where and when the previous one ends
+	bool queued = info.PendingMoves > 0 && commands.SentValid[iNode];
+	double fromPos = queued ? commands.SentPos[iNode] : transaction.Telemetry.Pos;
+	double startMsec = queued ? info.ArrivalMsec : sentMsec;
+
+	const MoveProfile& profile = transaction.Profile;
+
+	info.PredictedDurationMsec = info.Duration.predict(transaction.VirtualTargetCnts - fromPos, transaction.VelLimit, transaction.AccLimit,
+		profile.DecLimit, (double)profile.HeadCnts + profile.TailCnts, profile.HeadTailVelLimit);
+
+	if (transaction.QueryDuration)
+		info.Duration.verify(info.PredictedDurationMsec, transaction.DriveDurationMsec);
+
+	info.Duration.Moves++;
+	info.ArrivalMsec = startMsec + info.PredictedDurationMsec;
+	info.PendingMoves++;
+#endif // !SIMULATION
+}
+
+void MotorControllerCHOP::latchCapture(int iNode)
+{
+#ifndef SIMULATION
+	const NodeTransaction& transaction = motorTransactions[iNode];
+	MotorInfo& info = motorsInfo[iNode];
+
+	double prevPos = info.MeasuredPos;
+	double prevMsec = info.MeasuredTimeMsec;
+	double pos = transaction.Telemetry.Pos;
+	double msec = transaction.Telemetry.TimeMsec;
+
+	info.CapturedPos = transaction.CapturedPos;
+	info.CapturedHiResPos = transaction.CapturedHiResPos;
+	info.CaptureCount++;
+
+	// The edge happened between the two position samples; while moving, where the captured position
+	// falls between them places it in time far finer than the cook period, at rest only the window is known
+	double fraction = 0.5;
+
+	if (pos != prevPos)
 	{
-		updateMotorCommand(inputs, i);
+		fraction = (info.CapturedPos - prevPos) / (pos - prevPos);
+		fraction = fraction < 0.0 ? 0.0 : (fraction > 1.0 ? 1.0 : fraction);
 	}
+
+	info.CaptureTimeMsec = prevMsec > 0.0 ? prevMsec + fraction * (msec - prevMsec) : msec;
+#endif // !SIMULATION
 }
 
-void MotorControllerCHOP::sendMotorCommand(int iNode)
+void MotorControllerCHOP::alignTelemetry()
 {
-	if (isNodeAvailable(iNode))
+	// Nodes are read one after another, so every sample has its own age by the time it is output.
+	// Project each position forward to a common output time using its measured velocity.
+	outputTimeMsec = hostTimeMsec();
+
+	for (int i = 0; i < nodeCount; i++)
 	{
+		MotorInfo& info = motorsInfo[i];
+
+		// Never sampled, e.g. a node without an input
+		if (info.MeasuredTimeMsec <= 0.0)
+			continue;
+
+		double countsPerMsec = info.MeasuredVel * info.CountsPerRev / 60000.0;
+
+		info.SampleAgeMsec = outputTimeMsec - info.MeasuredTimeMsec;
+		info.CompensatedPos = info.MeasuredPos + countsPerMsec * info.SampleAgeMsec;
+	}
+}
+
+void MotorControllerCHOP::updateIdle()
+{
+	bool idle = recentEventCount == idleEventCount;
+
+	idleEventCount = recentEventCount;
+
 #ifndef SIMULATION
-		auto cmd = motorsInfo[iNode];
-		motorController.rotateMotor(iNode, cmd.CmpPos, cmd.CmdVel, cmd.CmdAcc);
+	// Counts status changes seen by the cook and by the background heartbeat alike
+	uint32_t statusChanges = motorController.getStatusChanges();
+
+	idle = idle && statusChanges == idleStatusChanges;
+	idleStatusChanges = statusChanges;
 #endif // !SIMULATION
+
+	for (int i = 0; i < nodeCount && idle; i++)
+	{
+		const MotorInfo& info = motorsInfo[i];
+
+		bool moving = info.ArrivalMsec > outputTimeMsec || info.GapOffsetCnts != 0.0
+			|| (info.IsEnable && !info.StatusFlags.is(STATUS_MOVE_DONE));
+
+		idle = !moving && !latencyProbes[i].isArmed();
 	}
+
+	// A playing trajectory moves the setpoints without any input changing
+	idle = idle && !trajectory.isPlaying();
+
+	controllerIdle = idle;
 }
 
-void MotorControllerCHOP::sendMotorCommands(const OP_Inputs* inputs)
+bool MotorControllerCHOP::isNodeAvailable(int iNode)
 {
-	size_t availableNode = 0;
-	auto numInput = inputs->getNumInputs();
+	return iNode >= 0 && iNode < nodeCount;
+}
 
-	availableNode = (numInput < nodeCount) ? numInput : nodeCount;
+void MotorControllerCHOP::drainControllerEvents()
+{
+	ControllerEvent event;
 
-	for (size_t i = 0; i < availableNode; i++)
+	while (controllerEvents.pop(event))
 	{
-		sendMotorCommand(i);
+		if (event.ErrorCode == EVENT_NOTICE)
+		{
+			recentNotices[recentNoticeCount % RECENT_NOTICE_COUNT] = event;
+			recentNoticeCount++;
+			continue;
+		}
+
+		totalErrorCount++;
+
+		if (event.Node >= 0 && event.Node < MAX_NODES)
+			motorsInfo[event.Node].ErrorCount++;
+
+		recentEvents[recentEventCount % RECENT_EVENT_COUNT] = event;
+		recentEventCount++;
 	}
 }
 
-bool MotorControllerCHOP::isNodeAvailable(int iNode)
+void MotorControllerCHOP::buildOutputChannels()
+{
+	outputChannels.clear();
+
+	outputChannels.push_back({ "errors_total", -1, CHAN_ERRORS_TOTAL });
+	outputChannels.push_back({ "errors_dropped", -1, CHAN_ERRORS_DROPPED });
+	outputChannels.push_back({ "clamps_total", -1, CHAN_CLAMPS_TOTAL });
+	outputChannels.push_back({ "moves_sent", -1, CHAN_MOVES_SENT });
+	outputChannels.push_back({ "moves_suppressed", -1, CHAN_MOVES_SUPPRESSED });
+	outputChannels.push_back({ "frame_gaps", -1, CHAN_FRAME_GAPS });
+	outputChannels.push_back({ "frames_dropped", -1, CHAN_FRAMES_DROPPED });
+	outputChannels.push_back({ "frame_gap_worst", -1, CHAN_FRAME_GAP_WORST });
+	outputChannels.push_back({ "frame_gap_worst_ms", -1, CHAN_FRAME_GAP_WORST_MSEC });
+
+	for (int i = 0; i < nodeCount; i++)
+	{
+		std::string prefix = "m" + std::to_string(i);
+
+		outputChannels.push_back({ prefix + "_pos", i, CHAN_NODE_POS });
+		outputChannels.push_back({ prefix + "_vel", i, CHAN_NODE_VEL });
+		outputChannels.push_back({ prefix + "_trq", i, CHAN_NODE_TRQ });
+		outputChannels.push_back({ prefix + "_age", i, CHAN_NODE_SAMPLE_AGE });
+
+		if (latencyCompensation)
+			outputChannels.push_back({ prefix + "_pos_comp", i, CHAN_NODE_POS_COMPENSATED });
+
+		if (auditMode != AUDIT_OFF)
+		{
+			outputChannels.push_back({ prefix + "_aud_rms", i, CHAN_NODE_AUDIT_RMS });
+			outputChannels.push_back({ prefix + "_aud_hp_rms", i, CHAN_NODE_AUDIT_HIGH_PASS_RMS });
+			outputChannels.push_back({ prefix + "_aud_max", i, CHAN_NODE_AUDIT_MAX });
+			outputChannels.push_back({ prefix + "_aud_dur", i, CHAN_NODE_AUDIT_DURATION });
+			outputChannels.push_back({ prefix + "_aud_trk", i, CHAN_NODE_AUDIT_TRACKING });
+			outputChannels.push_back({ prefix + "_aud_rms_mean", i, CHAN_NODE_AUDIT_MEAN_RMS });
+			outputChannels.push_back({ prefix + "_aud_peak", i, CHAN_NODE_AUDIT_PEAK });
+			outputChannels.push_back({ prefix + "_aud_count", i, CHAN_NODE_AUDIT_COUNT });
+		}
+
+		if (positionCapture)
+		{
+			outputChannels.push_back({ prefix + "_cap_pos", i, CHAN_NODE_CAPTURE_POS });
+			outputChannels.push_back({ prefix + "_cap_hires", i, CHAN_NODE_CAPTURE_HIRES_POS });
+			outputChannels.push_back({ prefix + "_cap_time", i, CHAN_NODE_CAPTURE_TIME });
+			outputChannels.push_back({ prefix + "_cap_age", i, CHAN_NODE_CAPTURE_AGE });
+			outputChannels.push_back({ prefix + "_cap_count", i, CHAN_NODE_CAPTURE_COUNT });
+		}
+
+		if (netWatchdogMsec > 0.0)
+		{
+			outputChannels.push_back({ prefix + "_hb_interval", i, CHAN_NODE_HEARTBEAT_INTERVAL });
+			outputChannels.push_back({ prefix + "_hb_jitter", i, CHAN_NODE_HEARTBEAT_JITTER });
+			outputChannels.push_back({ prefix + "_hb_max", i, CHAN_NODE_HEARTBEAT_MAX });
+			outputChannels.push_back({ prefix + "_hb_nearmiss", i, CHAN_NODE_HEARTBEAT_NEAR_MISSES });
+			outputChannels.push_back({ prefix + "_hb_miss", i, CHAN_NODE_HEARTBEAT_MISSES });
+		}
+
+		if (thermalMonitoring)
+		{
+			outputChannels.push_back({ prefix + "_rms", i, CHAN_NODE_RMS_LEVEL });
+			outputChannels.push_back({ prefix + "_rms_steady", i, CHAN_NODE_RMS_STEADY_STATE });
+			outputChannels.push_back({ prefix + "_rms_ttl", i, CHAN_NODE_TIME_TO_LIMIT });
+			outputChannels.push_back({ prefix + "_trqsat", i, CHAN_NODE_TORQUE_SATURATIONS });
+			outputChannels.push_back({ prefix + "_pwrfault", i, CHAN_NODE_POWER_FAULT });
+			outputChannels.push_back({ prefix + "_derate", i, CHAN_NODE_ACC_DERATE });
+		}
+
+		if (latencyProbing)
+		{
+			outputChannels.push_back({ prefix + "_lat_queue", i, CHAN_NODE_LATENCY_QUEUE });
+			outputChannels.push_back({ prefix + "_lat_serial", i, CHAN_NODE_LATENCY_SERIAL });
+			outputChannels.push_back({ prefix + "_lat_plan", i, CHAN_NODE_LATENCY_PLANNING });
+			outputChannels.push_back({ prefix + "_lat_mech", i, CHAN_NODE_LATENCY_MECHANICAL });
+			outputChannels.push_back({ prefix + "_lat_p50", i, CHAN_NODE_LATENCY_P50 });
+			outputChannels.push_back({ prefix + "_lat_p95", i, CHAN_NODE_LATENCY_P95 });
+			outputChannels.push_back({ prefix + "_lat_count", i, CHAN_NODE_LATENCY_COUNT });
+		}
+
+		outputChannels.push_back({ prefix + "_errors", i, CHAN_NODE_ERRORS });
+		outputChannels.push_back({ prefix + "_clamps", i, CHAN_NODE_CLAMPS });
+		outputChannels.push_back({ prefix + "_suppressed", i, CHAN_NODE_SUPPRESSED });
+		outputChannels.push_back({ prefix + "_warmstart", i, CHAN_NODE_WARM_START });
+
+		outputChannels.push_back({ prefix + "_arrival", i, CHAN_NODE_ARRIVAL });
+		outputChannels.push_back({ prefix + "_pending", i, CHAN_NODE_PENDING_MOVES });
+		outputChannels.push_back({ prefix + "_move_dur", i, CHAN_NODE_MOVE_DURATION });
+		outputChannels.push_back({ prefix + "_model_err", i, CHAN_NODE_MODEL_ERROR });
+
+		if (coordinatedMoves)
+		{
+			outputChannels.push_back({ prefix + "_group", i, CHAN_NODE_GROUP });
+			outputChannels.push_back({ prefix + "_group_dur", i, CHAN_NODE_GROUP_DURATION });
+		}
+
+		outputChannels.push_back({ prefix + "_enabled", i, CHAN_NODE_ENABLED });
+		outputChannels.push_back({ prefix + "_ready", i, CHAN_NODE_READY });
+		outputChannels.push_back({ prefix + "_movedone", i, CHAN_NODE_MOVE_DONE });
+		outputChannels.push_back({ prefix + "_alert", i, CHAN_NODE_ALERT });
+		outputChannels.push_back({ prefix + "_ev_movedone", i, CHAN_NODE_EVENTS_MOVE_DONE });
+		outputChannels.push_back({ prefix + "_ev_notready", i, CHAN_NODE_EVENTS_NOT_READY });
+		outputChannels.push_back({ prefix + "_ev_alert", i, CHAN_NODE_EVENTS_ALERT });
+		outputChannels.push_back({ prefix + "_ev_disabled", i, CHAN_NODE_EVENTS_DISABLED });
+	}
+
+	outputChannelsNodeCount = nodeCount;
+	outputChannelsDirty = false;
+}
+
+double MotorControllerCHOP::getOutputChannelValue(const OutputChannel& chan)
+{
+	switch (chan.Field)
+	{
+	case CHAN_ERRORS_TOTAL:		return totalErrorCount;
+	case CHAN_ERRORS_DROPPED:	return controllerEvents.dropped();
+	case CHAN_CLAMPS_TOTAL:		return clampTotal;
+	case CHAN_MOVES_SENT:		return movesSent;
+	case CHAN_MOVES_SUPPRESSED:	return movesSuppressed;
+	case CHAN_FRAME_GAPS:			return frameGaps.Gaps;
+	case CHAN_FRAMES_DROPPED:		return frameGaps.DroppedFrames;
+	case CHAN_FRAME_GAP_WORST:		return frameGaps.WorstFrames;
+	case CHAN_FRAME_GAP_WORST_MSEC:	return frameGaps.WorstMsec;
+	case CHAN_NODE_ERRORS:		return motorsInfo[chan.Node].ErrorCount;
+	case CHAN_NODE_CLAMPS:		return motorsInfo[chan.Node].ClampCount;
+	case CHAN_NODE_SUPPRESSED:	return motorsInfo[chan.Node].SuppressedCount;
+	case CHAN_NODE_WARM_START:	return motorsInfo[chan.Node].WarmStarted;
+	case CHAN_NODE_ARRIVAL:			return motorsInfo[chan.Node].ArrivalMsec > outputTimeMsec ? motorsInfo[chan.Node].ArrivalMsec - outputTimeMsec : 0.0;
+	case CHAN_NODE_PENDING_MOVES:	return motorsInfo[chan.Node].ArrivalMsec > outputTimeMsec ? motorsInfo[chan.Node].PendingMoves : 0;
+	case CHAN_NODE_MOVE_DURATION:	return motorsInfo[chan.Node].PredictedDurationMsec;
+	case CHAN_NODE_MODEL_ERROR:		return motorsInfo[chan.Node].Duration.ErrorMsec;
+	case CHAN_NODE_GROUP:			return motorsInfo[chan.Node].Group;
+	case CHAN_NODE_GROUP_DURATION:	return motorsInfo[chan.Node].GroupDurationMsec;
+	case CHAN_NODE_ENABLED:		return motorsInfo[chan.Node].StatusFlags.is(STATUS_ENABLED);
+	case CHAN_NODE_READY:		return motorsInfo[chan.Node].StatusFlags.is(STATUS_READY);
+	case CHAN_NODE_MOVE_DONE:	return motorsInfo[chan.Node].StatusFlags.is(STATUS_MOVE_DONE);
+	case CHAN_NODE_ALERT:		return motorsInfo[chan.Node].StatusFlags.is(STATUS_ALERT);
+	case CHAN_NODE_EVENTS_MOVE_DONE:	return motorsInfo[chan.Node].StatusFlags.RiseCount[STATUS_MOVE_DONE];
+	case CHAN_NODE_EVENTS_NOT_READY:	return motorsInfo[chan.Node].StatusFlags.RiseCount[STATUS_NOT_READY];
+	case CHAN_NODE_EVENTS_ALERT:		return motorsInfo[chan.Node].StatusFlags.RiseCount[STATUS_ALERT];
+	case CHAN_NODE_EVENTS_DISABLED:		return motorsInfo[chan.Node].StatusFlags.FallCount[STATUS_ENABLED];
+	case CHAN_NODE_POS:			return motorsInfo[chan.Node].Units.toUnits(motorsInfo[chan.Node].MeasuredPos);
+	case CHAN_NODE_VEL:			return motorsInfo[chan.Node].MeasuredVel;
+	case CHAN_NODE_TRQ:			return motorsInfo[chan.Node].MeasuredTrq;
+	case CHAN_NODE_SAMPLE_AGE:	return motorsInfo[chan.Node].SampleAgeMsec;
+	case CHAN_NODE_POS_COMPENSATED:	return motorsInfo[chan.Node].Units.toUnits(motorsInfo[chan.Node].CompensatedPos);
+	case CHAN_NODE_AUDIT_RMS:			return motorsInfo[chan.Node].Audit.latest().LowPassRMS;
+	case CHAN_NODE_AUDIT_HIGH_PASS_RMS:	return motorsInfo[chan.Node].Audit.latest().HighPassRMS;
+	case CHAN_NODE_AUDIT_MAX:			return std::fmax(std::fabs(motorsInfo[chan.Node].Audit.latest().MaxPos), std::fabs(motorsInfo[chan.Node].Audit.latest().MaxNeg));
+	case CHAN_NODE_AUDIT_DURATION:		return motorsInfo[chan.Node].Audit.latest().DurationMsec;
+	case CHAN_NODE_AUDIT_TRACKING:		return std::fmax(std::fabs((double)motorsInfo[chan.Node].Audit.latest().MaxTrackingPos), std::fabs((double)motorsInfo[chan.Node].Audit.latest().MaxTrackingNeg));
+	case CHAN_NODE_AUDIT_MEAN_RMS:		return motorsInfo[chan.Node].Audit.meanRMS();
+	case CHAN_NODE_AUDIT_PEAK:			return motorsInfo[chan.Node].Audit.peak();
+	case CHAN_NODE_AUDIT_COUNT:			return (double)motorsInfo[chan.Node].Audit.count();
+	case CHAN_NODE_CAPTURE_POS:			return motorsInfo[chan.Node].Units.toUnits(motorsInfo[chan.Node].CapturedPos);
+	case CHAN_NODE_CAPTURE_HIRES_POS:	return motorsInfo[chan.Node].Units.toUnits(motorsInfo[chan.Node].CapturedHiResPos);
+	case CHAN_NODE_CAPTURE_TIME:		return motorsInfo[chan.Node].CaptureTimeMsec;
+	case CHAN_NODE_CAPTURE_AGE:			return motorsInfo[chan.Node].CaptureCount > 0 ? outputTimeMsec - motorsInfo[chan.Node].CaptureTimeMsec : 0.0;
+	case CHAN_NODE_CAPTURE_COUNT:		return motorsInfo[chan.Node].CaptureCount;
+	case CHAN_NODE_HEARTBEAT_INTERVAL:		return motorsInfo[chan.Node].Heartbeat.IntervalMsec;
+	case CHAN_NODE_HEARTBEAT_JITTER:		return motorsInfo[chan.Node].Heartbeat.JitterMsec;
+	case CHAN_NODE_HEARTBEAT_MAX:			return motorsInfo[chan.Node].Heartbeat.MaxIntervalMsec;
+	case CHAN_NODE_HEARTBEAT_NEAR_MISSES:	return motorsInfo[chan.Node].Heartbeat.NearMisses;
+	case CHAN_NODE_HEARTBEAT_MISSES:		return motorsInfo[chan.Node].Heartbeat.Misses;
+	case CHAN_NODE_RMS_LEVEL:			return motorsInfo[chan.Node].Thermal.RmsLevelPct;
+	case CHAN_NODE_RMS_STEADY_STATE:	return motorsInfo[chan.Node].Thermal.SteadyStatePct;
+	case CHAN_NODE_TIME_TO_LIMIT:		return motorsInfo[chan.Node].Thermal.TimeToLimitSec;
+	case CHAN_NODE_TORQUE_SATURATIONS:	return motorsInfo[chan.Node].Thermal.TorqueSaturations;
+	case CHAN_NODE_POWER_FAULT:			return motorsInfo[chan.Node].Thermal.PowerFault;
+	case CHAN_NODE_ACC_DERATE:			return commands.AccScale[chan.Node];
+	case CHAN_NODE_LATENCY_QUEUE:		return latencyProbes[chan.Node].mean(STAGE_QUEUE);
+	case CHAN_NODE_LATENCY_SERIAL:		return latencyProbes[chan.Node].mean(STAGE_SERIAL);
+	case CHAN_NODE_LATENCY_PLANNING:	return latencyProbes[chan.Node].mean(STAGE_PLANNING);
+	case CHAN_NODE_LATENCY_MECHANICAL:	return latencyProbes[chan.Node].mean(STAGE_MECHANICAL);
+	case CHAN_NODE_LATENCY_P50:			return latencyProbes[chan.Node].percentile(STAGE_TOTAL, 0.50);
+	case CHAN_NODE_LATENCY_P95:			return latencyProbes[chan.Node].percentile(STAGE_TOTAL, 0.95);
+	case CHAN_NODE_LATENCY_COUNT:		return (double)latencyProbes[chan.Node].count();
+	}
+
+	return 0.0;
+}
+
+void MotorControllerCHOP::writeOutputChannels(CHOP_Output* output)
 {
-	return iNode < nodeCount ? true : false;
+	int32_t numChannels = output->numChannels < (int32_t)outputChannels.size() ? output->numChannels : (int32_t)outputChannels.size();
+
+	for (int32_t i = 0; i < numChannels; i++)
+	{
+		float value = (float)getOutputChannelValue(outputChannels[i]);
+
+		for (int32_t j = 0; j < output->numSamples; j++)
+			output->channels[i][j] = value;
+	}
 }
 
 void MotorControllerCHOP::fillNodeHeader(OP_InfoDATEntries* entries)
@@ -264,6 +1928,7 @@ void MotorControllerCHOP::fillNodeHeader(OP_InfoDATEntries* entries)
 	entries->values[6]->setString("positions (cnts)");
 	entries->values[7]->setString("velocity (rpm)");
 	entries->values[8]->setString("torque (% MAX)");
+	entries->values[9]->setString("errors");
 }
 
 void MotorControllerCHOP::fillNodeInfo(OP_InfoDATEntries* entries, int iNode)
@@ -274,19 +1939,19 @@ void MotorControllerCHOP::fillNodeInfo(OP_InfoDATEntries* entries, int iNode)
 	entries->values[0]->setString(temp.c_str());
 
 	if (isNodeAvailable(iNode)) {
-		temp = "Available";
+		temp = motorsInfo[iNode].WarmStarted ? "Available (warm start)" : "Available";
 		entries->values[1]->setString(temp.c_str());
 
 		temp = std::to_string(motorsInfo[iNode].IsEnable);
 		entries->values[2]->setString(temp.c_str());
 		
-		temp = std::to_string(motorsInfo[iNode].CmpPos);
+		temp = std::to_string(commands.CmpPos[iNode]);
 		entries->values[3]->setString(temp.c_str());
 
-		temp = std::to_string(motorsInfo[iNode].CmdVel);
+		temp = std::to_string(commands.CmdVel[iNode]);
 		entries->values[4]->setString(temp.c_str());
 
-		temp = std::to_string(motorsInfo[iNode].CmdAcc);
+		temp = std::to_string(commands.CmdAcc[iNode]);
 		entries->values[5]->setString(temp.c_str());
 
 		temp = std::to_string(motorsInfo[iNode].MeasuredPos);
@@ -297,6 +1962,9 @@ void MotorControllerCHOP::fillNodeInfo(OP_InfoDATEntries* entries, int iNode)
 
 		temp = std::to_string(motorsInfo[iNode].MeasuredTrq);
 		entries->values[8]->setString(temp.c_str());
+
+		temp = std::to_string(motorsInfo[iNode].ErrorCount);
+		entries->values[9]->setString(temp.c_str());
 	}
 	else {
 		temp = "Not Available";
@@ -308,6 +1976,7 @@ void MotorControllerCHOP::fillNodeInfo(OP_InfoDATEntries* entries, int iNode)
 		entries->values[6]->setString("..");
 		entries->values[7]->setString("..");
 		entries->values[8]->setString("..");
+		entries->values[9]->setString("..");
 	}
 }
 
@@ -315,13 +1984,127 @@ void MotorControllerCHOP::fillDebugInfo(OP_InfoDATEntries* entries)
 {
 	std::string temp;
 
-	entries->values[0]->setString("..");
-	entries->values[1]->setString("..");
-	entries->values[2]->setString("..");
-	entries->values[3]->setString("..");
-	entries->values[4]->setString("..");
-	entries->values[5]->setString("..");
+	entries->values[0]->setString("topology");
+
+	temp = std::to_string(topologyGeneration);
+	entries->values[1]->setString(temp.c_str());
+	entries->values[2]->setString("input axes");
+
+	temp = std::to_string(inputAxisCount);
+	entries->values[3]->setString(temp.c_str());
+	entries->values[4]->setString("frame gaps");
+
+	temp = std::to_string(frameGaps.Gaps);
+	entries->values[5]->setString(temp.c_str());
+	entries->values[6]->setString("worst gap (frames)");
+
+	temp = std::to_string(frameGaps.WorstFrames);
+	entries->values[7]->setString(temp.c_str());
+	entries->values[8]->setString("..");
+	entries->values[9]->setString("..");
+}
+
+void MotorControllerCHOP::fillAuditHeader(OP_InfoDATEntries* entries)
+{
+	entries->values[0]->setString("audit");
+	entries->values[1]->setString("moves");
+	entries->values[2]->setString("rms");
+	entries->values[3]->setString("max +");
+	entries->values[4]->setString("max -");
+	entries->values[5]->setString("high pass rms");
+	entries->values[6]->setString("duration (ms)");
+	entries->values[7]->setString("tracking + (cnts)");
+	entries->values[8]->setString("tracking - (cnts)");
+	entries->values[9]->setString("mean rms");
+}
+
+void MotorControllerCHOP::fillAuditInfo(OP_InfoDATEntries* entries, int iNode)
+{
+	char temp[32];
+
+	for (int i = 0; i < 10; i++)
+		entries->values[i]->setString("..");
+
+	snprintf(temp, sizeof(temp), "%d", iNode);
+	entries->values[0]->setString(temp);
+
+	const MotionAuditLog& audit = motorsInfo[iNode].Audit;
+
+	if (!isNodeAvailable(iNode) || audit.count() == 0)
+		return;
+
+	const AuditRecord& latest = audit.latest();
+
+	snprintf(temp, sizeof(temp), "%zu", audit.count());
+	entries->values[1]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", latest.LowPassRMS);
+	entries->values[2]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", latest.MaxPos);
+	entries->values[3]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", latest.MaxNeg);
+	entries->values[4]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", latest.HighPassRMS);
+	entries->values[5]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.1f", latest.DurationMsec);
+	entries->values[6]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%d", latest.MaxTrackingPos);
+	entries->values[7]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%d", latest.MaxTrackingNeg);
+	entries->values[8]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", audit.meanRMS());
+	entries->values[9]->setString(temp);
+}
+
+void MotorControllerCHOP::fillEventHeader(OP_InfoDATEntries* entries)
+{
+	entries->values[0]->setString("event");
+	entries->values[1]->setString("time (ms)");
+	entries->values[2]->setString("iNode");
+	entries->values[3]->setString("operation");
+	entries->values[4]->setString("error code");
+	entries->values[5]->setString("message");
 	entries->values[6]->setString("..");
 	entries->values[7]->setString("..");
 	entries->values[8]->setString("..");
+	entries->values[9]->setString("..");
+}
+
+void MotorControllerCHOP::fillEventInfo(OP_InfoDATEntries* entries, const ControllerEvent* history, size_t historySize,
+	size_t count, int iEvent)
+{
+	char temp[32];
+
+	for (int i = 0; i < 10; i++)
+		entries->values[i]->setString("..");
+
+	// Newest event first
+	if ((size_t)iEvent >= count || (size_t)iEvent >= historySize)
+		return;
+
+	size_t sequence = count - 1 - iEvent;
+	const ControllerEvent& event = history[sequence % historySize];
+
+	snprintf(temp, sizeof(temp), "%zu", sequence);
+	entries->values[0]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%.3f", event.TimestampMsec);
+	entries->values[1]->setString(temp);
+
+	snprintf(temp, sizeof(temp), "%d", event.Node);
+	entries->values[2]->setString(temp);
+
+	entries->values[3]->setString(eventOpName(event.Op));
+
+	snprintf(temp, sizeof(temp), "0x%08x", event.ErrorCode);
+	entries->values[4]->setString(temp);
+
+	entries->values[5]->setString(event.Message);
 }
@@ -15,6 +15,30 @@
 #include "CHOP_CPlusPlusBase.h"
 #include "SCHubController.h"
 #include "MotorInfo.h"
+#include "OutputChannels.h"
+#include "LatencyProbe.h"
+#include "CommandFilter.h"
+#include "CommandKernels.h"
+#include "CoordinatedMoves.h"
+#include "DatTable.h"
+#include "FrameGaps.h"
+#include "InputMapping.h"
+#include "KeyframeTrajectory.h"
+
+#include <string>
+#include <vector>
+
+#define MAX_NODES			16
+#define RECENT_EVENT_COUNT	16
+#define RECENT_NOTICE_COUNT	8
+
+// Where the motor commands come from
+enum InputMode
+{
+	INPUT_PER_AXIS = 0,		// Input i carries axis i on its first three channels
+	INPUT_WIDE,				// Input 0 carries every axis, matched by channel name
+	INPUT_MODE_COUNT
+};
 
 
 class MotorControllerCHOP : public CHOP_CPlusPlusBase
@@ -54,23 +78,145 @@ private:
 	const OP_NodeInfo*	myNodeInfo;
 
 	int nodeCount = 0;
-	MotorInfo motorsInfo[16];
+	uint32_t topologyGeneration = 0;
+	MotorInfo motorsInfo[MAX_NODES];
+
+	// Declared before the controller so it outlives every producer
+	EventQueue controllerEvents;
+
+	// Cook-side history of the events drained from controllerEvents, notices kept apart so they never push out an error
+	ControllerEvent recentEvents[RECENT_EVENT_COUNT];
+	size_t recentEventCount = 0;
+	ControllerEvent recentNotices[RECENT_NOTICE_COUNT];
+	size_t recentNoticeCount = 0;
+	uint32_t totalErrorCount = 0;
+
+	std::vector<OutputChannel> outputChannels;
+	int outputChannelsNodeCount = -1;
+	bool outputChannelsDirty = true;
+
+	// Parameters
+	bool latencyCompensation = false;
+	bool latencyProbing = false;
+	bool thermalMonitoring = false;
+	bool thermalDerating = false;
+	double netWatchdogMsec = NET_WATCHDOG_MSEC;
+	bool positionCapture = false;
+	AuditMode auditMode = AUDIT_OFF;
+	bool coordinatedMoves = false;
+	InputMode inputMode = INPUT_PER_AXIS;
+	FrameGapMode frameGapMode = FRAME_GAP_OFF;
+	bool cookOnDemand = false;
+
+	// Runtime page
+	double busCycleMsec = 0.0;				// 0 talks to the bus on every cook
+	bool readVelocity = true;
+	bool readTorque = true;
+	double commandDeadband = 0.0;			// Input units
+	CommandFilterSettings filterSettings;
+	double defaultVelRpm = DEFAULT_VEL_LIM_RPM;
+	double defaultAccRpmPerSec = DEFAULT_ACC_LIM_RPM_PER_SEC;
+	double defaultProfile[MOVE_FIELD_COUNT] = { MOVE_TRAPEZOID, 0.0, JERK_LIMIT_UNSET, 0.0, 0.0, 0.0 };
+	DatVersion modesTable;
+	bool loopKeyframes = false;
+
+	// Moves are held after a Stop pulse until Home or Reconnect, and while the controller homes
+	double lastBusCycleMsec = 0.0;
+	bool motorStopped = false;
+	bool controllerHoming = false;
+
+	// Nothing moved, changed or was reported during the last cook, TouchDesigner may stop cooking us
+	bool controllerIdle = false;
+	uint32_t idleStatusChanges = 0;
+	size_t idleEventCount = 0;
+
+	// Axes [0, inputAxisCount) may have a command this cook
+	int inputAxisCount = 0;
+	InputMapping inputMapping{ MAX_NODES };
+
+	// Axes with keyframes follow the trajectory instead of their input
+	KeyframeTrajectory trajectory{ MAX_NODES };
+
+	// Host time the cook started and the time the output values refer to
+	double cookStartMsec = 0.0;
+	double outputTimeMsec = 0.0;
+
+	LatencyProbe latencyProbes[MAX_NODES];
+
+	// Command path of every axis by field; the limits are copied from the topology whenever it changes,
+	// so clamping never touches the bus
+	MotorCommands commands{ MAX_NODES };
+	uint32_t clampTotal = 0;
+
+	FrameGapStats frameGaps;
+
+	uint32_t thermalSequence = 0;
+
+	// Per-axis views handed to coordinateGroups, laid out flat so the scaling loop vectorizes
+	int32_t coordGroup[MAX_NODES] = {};
+	double coordDistance[MAX_NODES] = {};
+	double coordCountsPerRev[MAX_NODES] = {};
+	double coordVel[MAX_NODES] = {};
+	double coordAcc[MAX_NODES] = {};
+	double groupDurationMsec[COORD_GROUP_MAX + 1] = {};
+
+	// Command filter, runs straight on the command columns
+	CommandFilter commandFilter{ MAX_NODES };
+	double lastFilterMsec = 0.0;
+
+	// Moves sent, and moves the raw input would have sent that filtering or the deadband held back
+	uint32_t movesSent = 0;
+	uint32_t movesSuppressed = 0;
+
+	// Bit g is set when a move of group g was loaded this cook and waits for its trigger
+	uint32_t triggeredGroups = 0;
 
 #ifndef SIMULATION
 	SCHubController motorController;
+
+	// One batch per cook, each axis touches its node's mutex once
+	NodeTransaction motorTransactions[MAX_NODES];
 #endif // !SIMULATION
 
+	double hostTimeMsec();
+
+	void updateParameters(const OP_Inputs* inputs);
+	std::string stateFilePrefix(const OP_Inputs* inputs);
+	void updateControlModes(const OP_Inputs* inputs);
 	void updateNodeCount();
+	void updateThermal();
+	void alignTelemetry();
+	void updateIdle();
+	void drainControllerEvents();
+
+	void buildOutputChannels();
+	double getOutputChannelValue(const OutputChannel& chan);
+	void writeOutputChannels(CHOP_Output* output);
 
 	void updateMotorCommand(const OP_Inputs* inputs, int iNode);
+	void updateMotorCommand(const OP_CHOPInput* input, int iNode);
+	void setMotorCommand(int iNode, double pos, double vel, double acc, double group, const double profile[MOVE_FIELD_COUNT]);
 	void updateMotorCommands(const OP_Inputs* inputs);
+	void updateKeyframedCommands(const OP_Inputs* inputs);
+	void bridgeFrameGaps(const OP_Inputs* inputs);
+	void filterMotorCommands(const OP_Inputs* inputs);
+	void clampMotorCommands(const OP_Inputs* inputs);
+	void coordinateMotorCommands(const OP_Inputs* inputs);
 	
 	void sendMotorCommand(int iNode);
 	void sendMotorCommands(const OP_Inputs* inputs);
+	void triggerMotorCommands();
+	void updateMotorState(int iNode);
+	void latchCapture(int iNode);
+	void predictArrival(int iNode);
 	
 	bool isNodeAvailable(int iNode);
 	
 	void fillNodeHeader(OP_InfoDATEntries* entries);
 	void fillNodeInfo(OP_InfoDATEntries* entries, int iNode);
 	void fillDebugInfo(OP_InfoDATEntries* entries);
+	void fillAuditHeader(OP_InfoDATEntries* entries);
+	void fillAuditInfo(OP_InfoDATEntries* entries, int iNode);
+	void fillEventHeader(OP_InfoDATEntries* entries);
+	void fillEventInfo(OP_InfoDATEntries* entries, const ControllerEvent* history, size_t historySize, size_t count, int iEvent);
 };
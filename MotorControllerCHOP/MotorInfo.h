@@ -1,13 +1,81 @@
 #pragma once
 
+#include "AxisUnits.h"
+#include "MotionAuditLog.h"
+#include "MoveDurationModel.h"
+#include "MoveProfile.h"
+#include "NetWatchdog.h"
+#include "NodeProfiles.h"
+#include "StatusSnapshot.h"
+#include "ThermalMonitor.h"
+
+#include <cstdint>
+
+#define DEFAULT_COUNTS_PER_REV	6400
+
 struct MotorInfo
 {
-	double	CmpPos		= 0.0;
-	double	CmdVel		= 0.0;
-	double	CmdAcc		= 0.0;
+	// The command itself, from the input to the last move sent, is kept per field in MotorCommands
+
+	// Part of a jump across dropped frames not yet released to the drive
+	double	GapOffsetCnts		= 0.0;
+	double	GapStepCnts			= 0.0;
+
+	// Moves the filter or the deadband held back, and commands brought inside the node limits
+	uint32_t SuppressedCount	= 0;
+	uint32_t ClampCount			= 0;
+
+	// Predicted end of the last move queued on the drive, every move queues behind the previous one
+	MoveDurationModel Duration;
+	double	PredictedDurationMsec	= 0.0;
+	double	ArrivalMsec				= 0.0;
+	uint32_t PendingMoves			= 0;
+
+	// Shape of the next move as the node will run it and of the last one sent, a new shape goes out like a new target
+	MoveProfile Profile;
+	MoveProfile SentProfile;
+
+	// Coordinated group from the input, 0 moves on its own; the trigger group last written to the drive
+	int32_t	Group				= 0;
+	int32_t	DriveTriggerGroup	= 0;
+	double	GroupDurationMsec	= 0.0;
 
 	bool	IsEnable	= false;
 	double	MeasuredPos = 0.0;
 	double	MeasuredVel = 0.0;
 	double	MeasuredTrq = 0.0;
-};
\ No newline at end of file
+	double	CommandedPos = 0.0;
+
+	// Host time of MeasuredPos and how old it is when the CHOP outputs it
+	double	MeasuredTimeMsec	= 0.0;
+	double	SampleAgeMsec		= 0.0;
+	double	CompensatedPos		= 0.0;
+	double	CountsPerRev		= DEFAULT_COUNTS_PER_REV;
+	AxisUnits Units;					// From the topology, input and output positions are in these units
+	AxisControlMode ControlMode	= CONTROL_ABSOLUTE;
+
+	NodeStatus StatusFlags;
+
+	// Last position latched by the drive on input A and the host time it is estimated to belong to
+	bool	CaptureOnRise		= false;
+	double	CapturedPos			= 0.0;
+	double	CapturedHiResPos	= 0.0;
+	double	CaptureTimeMsec		= 0.0;
+	uint32_t CaptureCount		= 0;
+
+	// In-drive statistics of the completed moves, only Advanced nodes collect them
+	bool	IsAdvanced			= false;
+	AuditMode AuditSelected		= AUDIT_OFF;
+	MotionAuditLog Audit;
+
+	// Gaps between the exchanges that keep the node's network watchdog fed
+	HeartbeatStats Heartbeat;
+
+	// Latest copy of the controller's thermal model, its acceleration scale goes to MotorCommands::AccScale
+	ThermalState Thermal;
+
+	// Homing was skipped on connect because the warm start cache vouched for the node
+	bool	WarmStarted	= false;
+
+	uint32_t ErrorCount	= 0;
+};
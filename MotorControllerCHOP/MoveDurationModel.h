@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#define DURATION_VERIFY_INTERVAL	16		// Every n-th move from rest is checked against MovePosnDurationMsec
+#define DURATION_OFFSET_FILTER		0.25	// Weight of each verification in the learned offset
+
+// Local estimate of how long the drive takes for a move: a trapezoid from the commanded velocity and
+// acceleration, plus the delay the jerk limit (RAS) adds, plus an offset learned from the drive itself
+struct MoveDurationModel
+{
+	double		CountsPerRev	= 0.0;
+	double		JerkDelayMsec	= 0.0;	// Motion.JrkLimitDelay
+	double		OffsetMsec		= 0.0;
+	double		ErrorMsec		= 0.0;	// Running mean absolute error before correction
+	uint32_t	Moves			= 0;
+	uint32_t	Verified		= 0;
+
+	// An asymmetric move brakes at decRpmPerSec, 0 brakes like it accelerates. A head-tail move covers
+	// slowCnts of its distance at no more than slowRpm, taken as cruising there instead of at velRpm
+	double predict(double distanceCnts, double velRpm, double accRpmPerSec, double decRpmPerSec = 0.0,
+		double slowCnts = 0.0, double slowRpm = 0.0) const
+	{
+		double distance = std::fabs(distanceCnts);
+		double vel = velRpm * CountsPerRev / 60000.0;				// Counts per ms
+		double acc = accRpmPerSec * CountsPerRev / 60.0 / 1.0e6;	// Counts per ms^2
+		double dec = decRpmPerSec > 0.0 ? decRpmPerSec * CountsPerRev / 60.0 / 1.0e6 : acc;
+
+		if (distance <= 0.0 || vel <= 0.0 || acc <= 0.0)
+			return 0.0;
+
+		// Distance the ramps take at full velocity, triangular when the axis never reaches it
+		double rampCnts = 0.5 * vel * vel * (1.0 / acc + 1.0 / dec);
+		double profileMsec;
+
+		if (distance < rampCnts)
+		{
+			double peak = std::sqrt(2.0 * distance * acc * dec / (acc + dec));
+			profileMsec = peak / acc + peak / dec;
+		}
+		else
+		{
+			profileMsec = distance / vel + 0.5 * vel / acc + 0.5 * vel / dec;
+		}
+
+		double slowVel = slowRpm * CountsPerRev / 60000.0;
+
+		if (slowCnts > 0.0 && slowVel > 0.0 && slowVel < vel)
+			profileMsec += std::fmin(slowCnts, distance) * (1.0 / slowVel - 1.0 / vel);
+
+		return profileMsec + JerkDelayMsec + OffsetMsec;
+	}
+
+	bool wantsVerification() const
+	{
+		return Verified == 0 || Moves % DURATION_VERIFY_INTERVAL == 0;
+	}
+
+	void verify(double predictedMsec, double driveMsec)
+	{
+		double error = driveMsec - predictedMsec;
+
+		ErrorMsec = Verified == 0 ? std::fabs(error) : ErrorMsec + DURATION_OFFSET_FILTER * (std::fabs(error) - ErrorMsec);
+		OffsetMsec += Verified == 0 ? error : DURATION_OFFSET_FILTER * error;
+		Verified++;
+	}
+};
@@ -0,0 +1,78 @@
+#include "MoveProfile.h"
+#include "NodeLimits.h"
+
+#include <cmath>
+
+static uint32_t toDistanceCnts(double units, double countsPerUnit)
+{
+	double counts = std::round(std::fabs(units * countsPerUnit));
+
+	if (!std::isfinite(counts))
+		return 0;
+
+	return counts > (double)INT32_MAX ? (uint32_t)INT32_MAX : (uint32_t)counts;
+}
+
+MoveProfile makeMoveProfile(const double fields[MOVE_FIELD_COUNT], double countsPerUnit)
+{
+	MoveProfile profile;
+
+	double type = std::round(fields[MOVE_FIELD_TYPE]);
+
+	if (type >= 0.0 && type < MOVE_PROFILE_COUNT)
+		profile.Type = (MoveProfileType)(int)type;
+
+	double jerk = std::round(fields[MOVE_FIELD_JERK]);
+
+	if (jerk >= 0.0 && jerk <= (double)INT32_MAX)
+		profile.JerkLimit = (int32_t)jerk;
+
+	double dec = fields[MOVE_FIELD_DEC];
+	double headTailVel = fields[MOVE_FIELD_HEAD_TAIL_VEL];
+
+	profile.DecLimit = dec > 0.0 && std::isfinite(dec) ? dec : 0.0;
+	profile.HeadCnts = toDistanceCnts(fields[MOVE_FIELD_HEAD], countsPerUnit);
+	profile.TailCnts = toDistanceCnts(fields[MOVE_FIELD_TAIL], countsPerUnit);
+	profile.HeadTailVelLimit = headTailVel > 0.0 && std::isfinite(headTailVel) ? headTailVel : 0.0;
+
+	return profile;
+}
+
+MoveProfile resolveMoveProfile(const MoveProfile& requested, bool isAdvanced, double accRpmPerSec, double accScale,
+	double accMaxRpmPerSec, double velMaxRpm)
+{
+	MoveProfile profile = requested;
+
+	bool slowSection = profile.HeadTailVelLimit > 0.0 && (profile.HeadCnts > 0 || profile.TailCnts > 0);
+
+	if (!isAdvanced || (profile.Type == MOVE_HEAD_TAIL && !slowSection))
+		profile.Type = MOVE_TRAPEZOID;
+
+	if (profile.Type == MOVE_ASYMMETRIC)
+	{
+		// Derated with the acceleration, a hot motor brakes as gently as it speeds up
+		double dec = profile.DecLimit > 0.0 ? profile.DecLimit * accScale : accRpmPerSec;
+		uint32_t clamped = CLAMP_NONE;
+
+		profile.DecLimit = clampValue(dec, ACC_LIM_MIN_RPM_PER_SEC, accMaxRpmPerSec, CLAMP_ACC, clamped);
+	}
+	else
+	{
+		profile.DecLimit = 0.0;
+	}
+
+	if (profile.Type == MOVE_HEAD_TAIL)
+	{
+		uint32_t clamped = CLAMP_NONE;
+
+		profile.HeadTailVelLimit = clampValue(profile.HeadTailVelLimit, VEL_LIM_MIN_RPM, velMaxRpm, CLAMP_VEL, clamped);
+	}
+	else
+	{
+		profile.HeadCnts = 0;
+		profile.TailCnts = 0;
+		profile.HeadTailVelLimit = 0.0;
+	}
+
+	return profile;
+}
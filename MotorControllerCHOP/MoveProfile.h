@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#define JERK_LIMIT_UNSET	-1		// Leave the drive's jerk limit as ClearView left it
+
+// Shape of the moves sent to an axis. Asymmetric and head-tail moves are IMotionAdv features,
+// a node without them runs the trapezoid
+enum MoveProfileType : uint8_t
+{
+	MOVE_TRAPEZOID = 0,
+	MOVE_ASYMMETRIC,		// Decelerates at DecLimit instead of the acceleration limit
+	MOVE_HEAD_TAIL,			// Stays under HeadTailVelLimit for the first HeadCnts and the last TailCnts
+	MOVE_PROFILE_COUNT
+};
+
+// Order of the profile settings as they come in, from the input channels or the parameters
+enum MoveProfileField
+{
+	MOVE_FIELD_TYPE = 0,
+	MOVE_FIELD_DEC,				// RPM per second, 0 decelerates like it accelerates
+	MOVE_FIELD_JERK,			// Motion.JrkLimit, negative leaves the drive's setting
+	MOVE_FIELD_HEAD,			// Input position units
+	MOVE_FIELD_TAIL,
+	MOVE_FIELD_HEAD_TAIL_VEL,	// RPM
+	MOVE_FIELD_COUNT
+};
+
+// Everything besides velocity and acceleration that shapes a move. It reaches the drive only with
+// a move, and each register only when it differs from what was last written to it.
+struct MoveProfile
+{
+	MoveProfileType	Type				= MOVE_TRAPEZOID;
+	int32_t			JerkLimit			= JERK_LIMIT_UNSET;		// Applies to every type
+	double			DecLimit			= 0.0;		// RPM per second, asymmetric only
+	uint32_t		HeadCnts			= 0;		// Head-tail only
+	uint32_t		TailCnts			= 0;
+	double			HeadTailVelLimit	= 0.0;		// RPM
+
+	bool	operator==(const MoveProfile& other) const
+	{
+		return Type == other.Type && JerkLimit == other.JerkLimit && DecLimit == other.DecLimit
+			&& HeadCnts == other.HeadCnts && TailCnts == other.TailCnts && HeadTailVelLimit == other.HeadTailVelLimit;
+	}
+
+	bool	operator!=(const MoveProfile& other) const { return !(*this == other); }
+};
+
+// Profile from the raw settings, head and tail converted to counts; anything that does not parse is left at its default
+MoveProfile makeMoveProfile(const double fields[MOVE_FIELD_COUNT], double countsPerUnit);
+
+// What the node will actually run: a shape it cannot do, or one missing its settings, falls back to the
+// trapezoid, the deceleration is limited like the acceleration, and settings the type ignores are cleared
+// so they never count as a change
+MoveProfile resolveMoveProfile(const MoveProfile& requested, bool isAdvanced, double accRpmPerSec, double accScale,
+	double accMaxRpmPerSec, double velMaxRpm);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+#define NET_WATCHDOG_MSEC			500.0	// Ramped node stop when the host goes quiet this long, 0 disables
+#define NET_WATCHDOG_NEAR_MISS		0.5		// Fraction of the watchdog a gap may reach before it counts as a near miss
+#define HEARTBEAT_FILTER			0.05	// Weight of each new interval in the running averages
+#define KEEP_ALIVE_FRACTION			0.25	// Background heartbeat after this fraction of the watchdog without traffic
+
+// Gaps between consecutive successful exchanges with one node, measured against its watchdog
+struct HeartbeatStats
+{
+	double		LastMsec			= 0.0;
+	double		LastIntervalMsec	= 0.0;
+	double		IntervalMsec		= 0.0;	// Running average
+	double		JitterMsec			= 0.0;	// Running average of the deviation from IntervalMsec
+	double		MaxIntervalMsec		= 0.0;
+	uint32_t	Count				= 0;
+	uint32_t	NearMisses			= 0;
+	uint32_t	Misses				= 0;	// Gaps long enough for the drive to have stopped itself
+
+	// True when the node has been quiet long enough for its watchdog to have stopped it
+	bool expired(double timeMsec, double watchdogMsec) const
+	{
+		return watchdogMsec > 0.0 && Count > 0 && timeMsec - LastMsec > watchdogMsec;
+	}
+
+	// The watchdog was just armed, the next gap is measured from here
+	void restart(double timeMsec)
+	{
+		if (Count > 0)
+			LastMsec = timeMsec;
+	}
+
+	// Returns true when this gap exceeded the watchdog
+	bool update(double timeMsec, double watchdogMsec)
+	{
+		bool missed = false;
+
+		if (Count > 0)
+		{
+			double interval = timeMsec - LastMsec;
+
+			LastIntervalMsec = interval;
+
+			if (Count == 1)
+				IntervalMsec = interval;
+
+			double deviation = interval > IntervalMsec ? interval - IntervalMsec : IntervalMsec - interval;
+
+			IntervalMsec += HEARTBEAT_FILTER * (interval - IntervalMsec);
+			JitterMsec += HEARTBEAT_FILTER * (deviation - JitterMsec);
+
+			if (interval > MaxIntervalMsec)
+				MaxIntervalMsec = interval;
+
+			if (watchdogMsec > 0.0)
+			{
+				if (interval > watchdogMsec)
+				{
+					Misses++;
+					missed = true;
+				}
+				else if (interval > watchdogMsec * NET_WATCHDOG_NEAR_MISS)
+				{
+					NearMisses++;
+				}
+			}
+		}
+
+		LastMsec = timeMsec;
+		Count++;
+
+		return missed;
+	}
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#define VEL_LIM_MIN_RPM				1.0
+#define ACC_LIM_MIN_RPM_PER_SEC		1.0
+#define ACC_LIM_MAX_RPM_PER_SEC		500000.0
+
+// Result flags of clampCommand
+#define CLAMP_NONE		0x0
+#define CLAMP_POS		0x1
+#define CLAMP_VEL		0x2
+#define CLAMP_ACC		0x4
+#define CLAMP_REJECT	0x8		// Non-finite input, the command must not be sent
+
+// Drive limits read once when the node is enumerated
+struct NodeLimits
+{
+	bool	Valid				= false;
+	double	MaxVelRpm			= 0.0;		// Limits.MotorSpeedLimit
+	double	MaxAccRpmPerSec		= ACC_LIM_MAX_RPM_PER_SEC;
+	double	TrqGlobalPct		= 0.0;		// Limits.TrqGlobal
+	bool	SoftLimitsActive	= false;	// Only enforced by the drive once homed
+	int32_t	SoftLimitMin		= INT32_MIN;
+	int32_t	SoftLimitMax		= INT32_MAX;
+	double	JerkDelayMsec		= 0.0;		// Motion.JrkLimitDelay, what the S-curve adds to every move
+};
+
+inline double clampValue(double value, double low, double high, uint32_t flag, uint32_t& result)
+{
+	if (value < low)
+	{
+		result |= flag;
+		return low;
+	}
+
+	if (value > high)
+	{
+		result |= flag;
+		return high;
+	}
+
+	return value;
+}
+
+// Bring a command inside what the drive accepts so an out-of-range value never costs a
+// rejected round trip. Returns the CLAMP_* flags that were applied.
+inline uint32_t clampCommand(const NodeLimits& limits, double& pos, double& vel, double& acc)
+{
+	uint32_t result = CLAMP_NONE;
+
+	if (!std::isfinite(pos) || !std::isfinite(vel) || !std::isfinite(acc))
+		return CLAMP_REJECT;
+
+	double posMin = limits.SoftLimitsActive ? limits.SoftLimitMin : INT32_MIN;
+	double posMax = limits.SoftLimitsActive ? limits.SoftLimitMax : INT32_MAX;
+	double velMax = limits.Valid && limits.MaxVelRpm > 0.0 ? limits.MaxVelRpm : HUGE_VAL;
+
+	pos = clampValue(pos, posMin, posMax, CLAMP_POS, result);
+	vel = clampValue(vel, VEL_LIM_MIN_RPM, velMax, CLAMP_VEL, result);
+	acc = clampValue(acc, ACC_LIM_MIN_RPM_PER_SEC, limits.MaxAccRpmPerSec, CLAMP_ACC, result);
+
+	return result;
+}
@@ -0,0 +1,171 @@
+#include "NodeProfiles.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static const char* controlModeNames[CONTROL_MODE_COUNT] = { "absolute", "relative", "unbounded" };
+
+const char* controlModeName(AxisControlMode mode)
+{
+	return mode < CONTROL_MODE_COUNT ? controlModeNames[mode] : "unknown";
+}
+
+bool parseControlMode(const char* name, AxisControlMode& mode)
+{
+	for (int i = 0; i < CONTROL_MODE_COUNT; i++)
+	{
+		if (strcmp(name, controlModeNames[i]) == 0)
+		{
+			mode = (AxisControlMode)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint64_t hashFile(const char* path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+		return 0;
+
+	uint64_t hash = 14695981039346656037ull;
+	char buffer[4096];
+
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+	{
+		for (std::streamsize i = 0; i < file.gcount(); i++)
+		{
+			hash ^= (uint8_t)buffer[i];
+			hash *= 1099511628211ull;
+		}
+	}
+
+	return hash;
+}
+
+NodeProfileStore::NodeProfileStore(const char* path) : _path(path)
+{
+}
+
+bool NodeProfileStore::load()
+{
+	std::ifstream file(_path);
+
+	if (!file)
+		return false;
+
+	_profiles.clear();
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		std::string field[12];
+
+		for (size_t i = 0; i < 12; i++)
+			std::getline(fields, field[i], '\t');
+
+		NodeProfile profile;
+
+		try
+		{
+			profile.SerialNumber	= (uint32_t)std::stoul(field[0]);
+			profile.Axis			= std::stoi(field[1]);
+			profile.ControlMode		= (AxisControlMode)std::stoi(field[2]);
+			profile.CountsPerUnit	= std::stod(field[3]);
+			profile.MaxVelRpm		= std::stod(field[4]);
+			profile.TrqGlobalPct	= std::stod(field[5]);
+			profile.ConfigHash		= std::stoull(field[6]);
+
+			// Added later, older files leave the units as counts_per_unit gives them
+			if (!field[9].empty())
+			{
+				profile.GearRatio	= std::stod(field[9]);
+				profile.UnitsPerRev	= std::stod(field[10]);
+				profile.Direction	= std::stoi(field[11]) < 0 ? -1 : 1;
+			}
+		}
+		catch (std::exception&)
+		{
+			// A hand-edited line that does not parse is skipped, the node gets a fresh profile
+			continue;
+		}
+
+		profile.UserID = field[7];
+		profile.ConfigFile = field[8];
+
+		if (profile.ControlMode >= CONTROL_MODE_COUNT)
+			profile.ControlMode = CONTROL_ABSOLUTE;
+
+		if (profile.CountsPerUnit == 0.0)
+			profile.CountsPerUnit = 1.0;
+
+		if (profile.GearRatio <= 0.0)
+			profile.GearRatio = 1.0;
+
+		_profiles.push_back(profile);
+	}
+
+	return true;
+}
+
+bool NodeProfileStore::save() const
+{
+	std::ofstream file(_path, std::ios::trunc);
+
+	if (!file)
+		return false;
+
+	file.precision(17);
+	file << "# serial\taxis\tmode\tcounts_per_unit\tmax_vel_rpm\ttrq_global_pct\tconfig_hash\tuser_id\tconfig_file"
+		"\tgear_ratio\tunits_per_rev\tdirection\n";
+
+	for (const NodeProfile& profile : _profiles)
+	{
+		file << profile.SerialNumber << "\t" << profile.Axis << "\t" << (int)profile.ControlMode << "\t"
+			<< profile.CountsPerUnit << "\t" << profile.MaxVelRpm << "\t" << profile.TrqGlobalPct << "\t"
+			<< profile.ConfigHash << "\t" << profile.UserID << "\t" << profile.ConfigFile << "\t"
+			<< profile.GearRatio << "\t" << profile.UnitsPerRev << "\t" << profile.Direction << "\n";
+	}
+
+	return (bool)file;
+}
+
+NodeProfile* NodeProfileStore::findBySerial(uint32_t serialNumber)
+{
+	for (NodeProfile& profile : _profiles)
+	{
+		if (profile.SerialNumber == serialNumber)
+			return &profile;
+	}
+
+	return nullptr;
+}
+
+NodeProfile* NodeProfileStore::findByUserID(const std::string& userID)
+{
+	if (userID.empty())
+		return nullptr;
+
+	for (NodeProfile& profile : _profiles)
+	{
+		if (profile.UserID == userID)
+			return &profile;
+	}
+
+	return nullptr;
+}
+
+NodeProfile& NodeProfileStore::add(const NodeProfile& profile)
+{
+	_profiles.push_back(profile);
+	return _profiles.back();
+}
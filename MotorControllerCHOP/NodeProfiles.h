@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <deque>
+
+#define NODE_PROFILE_SUFFIX	".profiles"		// Appended to the controller's state file prefix
+#define PROFILE_UNSET		-1.0	// Leave the drive setting as it is
+#define PROFILE_NO_AXIS		-1
+
+// How an axis interprets its position input. Every mode takes a target; relative axes send the drive
+// the step from the previous target, unbounded axes also fold whole turns out of the drive's counter
+enum AxisControlMode : uint8_t
+{
+	CONTROL_ABSOLUTE = 0,
+	CONTROL_RELATIVE,
+	CONTROL_UNBOUNDED,
+	CONTROL_MODE_COUNT
+};
+
+const char* controlModeName(AxisControlMode mode);
+bool parseControlMode(const char* name, AxisControlMode& mode);
+
+// Everything the controller needs to bring one physical node back exactly as it was left
+struct NodeProfile
+{
+	uint32_t		SerialNumber	= 0;
+	std::string		UserID;
+	int32_t			Axis			= PROFILE_NO_AXIS;	// Input driving this node, independent of bus order
+	AxisControlMode	ControlMode		= CONTROL_ABSOLUTE;
+	double			CountsPerUnit	= 1.0;				// Input position units to counts, when no lead is given
+	double			GearRatio		= 1.0;				// Motor revolutions per load revolution
+	double			UnitsPerRev		= 0.0;				// Lead, units the load travels per load revolution
+	int32_t			Direction		= 1;				// -1 reverses the axis
+	double			MaxVelRpm		= PROFILE_UNSET;	// Limits.MotorSpeedLimit
+	double			TrqGlobalPct	= PROFILE_UNSET;	// Limits.TrqGlobal
+	std::string		ConfigFile;							// Drive configuration kept loaded on the node
+	uint64_t		ConfigHash		= 0;				// Hash of ConfigFile when it was last loaded
+};
+
+// FNV-1a over the file content, 0 when the file cannot be read
+uint64_t hashFile(const char* path);
+
+// Profiles of every node ever seen, kept in a local tab separated file
+class NodeProfileStore
+{
+private:
+	std::string _path;
+	std::deque<NodeProfile> _profiles;	// Stable addresses, callers hold on to what find and add return
+
+public:
+	NodeProfileStore(const char* path);
+
+	void setPath(const std::string& path) { _path = path; }
+
+	bool load();
+	bool save() const;
+
+	NodeProfile* findBySerial(uint32_t serialNumber);
+	NodeProfile* findByUserID(const std::string& userID);
+	NodeProfile& add(const NodeProfile& profile);
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "pubSysCls.h"
+#include "AxisUnits.h"
+#include "NodeLimits.h"
+#include "NodeProfiles.h"
+
+#include <cstdint>
+
+// Snapshot of what is attached to the port. Built off the cook thread and published as a
+// whole, so readers always see a consistent table. Per-node tables are in axis order,
+// AxisNode maps each axis back to its position on the bus.
+struct NodeTopology
+{
+	uint32_t	Generation		= 0;
+	openStates	PortState		= UNKNOWN;
+	Uint16		NodeCount		= 0;
+
+	Uint16		AxisNode[MN_API_MAX_NODES]				= {};
+	uint32_t	SerialNumber[MN_API_MAX_NODES]			= {};
+	uint32_t	PositioningResolution[MN_API_MAX_NODES]	= {};	// Counts per revolution
+	bool		IsAdvanced[MN_API_MAX_NODES]			= {};
+	bool		CaptureOnRise[MN_API_MAX_NODES]			= {};	// Edge of input A the position capture latches on
+	NodeLimits	Limits[MN_API_MAX_NODES];
+	NodeProfile	Profile[MN_API_MAX_NODES];
+	AxisUnits	Units[MN_API_MAX_NODES];
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+
+// Value carried by one channel of the CHOP output
+enum ChannelField
+{
+	CHAN_ERRORS_TOTAL = 0,
+	CHAN_ERRORS_DROPPED,
+	CHAN_CLAMPS_TOTAL,
+	CHAN_MOVES_SENT,
+	CHAN_MOVES_SUPPRESSED,
+	CHAN_FRAME_GAPS,
+	CHAN_FRAMES_DROPPED,
+	CHAN_FRAME_GAP_WORST,
+	CHAN_FRAME_GAP_WORST_MSEC,
+	CHAN_NODE_ERRORS,
+	CHAN_NODE_CLAMPS,
+	CHAN_NODE_SUPPRESSED,
+	CHAN_NODE_WARM_START,
+	CHAN_NODE_ARRIVAL,
+	CHAN_NODE_PENDING_MOVES,
+	CHAN_NODE_MOVE_DURATION,
+	CHAN_NODE_MODEL_ERROR,
+	CHAN_NODE_GROUP,
+	CHAN_NODE_GROUP_DURATION,
+	CHAN_NODE_ENABLED,
+	CHAN_NODE_READY,
+	CHAN_NODE_MOVE_DONE,
+	CHAN_NODE_ALERT,
+	CHAN_NODE_EVENTS_MOVE_DONE,
+	CHAN_NODE_EVENTS_NOT_READY,
+	CHAN_NODE_EVENTS_ALERT,
+	CHAN_NODE_EVENTS_DISABLED,
+	CHAN_NODE_POS,
+	CHAN_NODE_VEL,
+	CHAN_NODE_TRQ,
+	CHAN_NODE_SAMPLE_AGE,
+	CHAN_NODE_POS_COMPENSATED,
+	CHAN_NODE_AUDIT_RMS,
+	CHAN_NODE_AUDIT_HIGH_PASS_RMS,
+	CHAN_NODE_AUDIT_MAX,
+	CHAN_NODE_AUDIT_DURATION,
+	CHAN_NODE_AUDIT_TRACKING,
+	CHAN_NODE_AUDIT_MEAN_RMS,
+	CHAN_NODE_AUDIT_PEAK,
+	CHAN_NODE_AUDIT_COUNT,
+	CHAN_NODE_CAPTURE_POS,
+	CHAN_NODE_CAPTURE_HIRES_POS,
+	CHAN_NODE_CAPTURE_TIME,
+	CHAN_NODE_CAPTURE_AGE,
+	CHAN_NODE_CAPTURE_COUNT,
+	CHAN_NODE_HEARTBEAT_INTERVAL,
+	CHAN_NODE_HEARTBEAT_JITTER,
+	CHAN_NODE_HEARTBEAT_MAX,
+	CHAN_NODE_HEARTBEAT_NEAR_MISSES,
+	CHAN_NODE_HEARTBEAT_MISSES,
+	CHAN_NODE_RMS_LEVEL,
+	CHAN_NODE_RMS_STEADY_STATE,
+	CHAN_NODE_TIME_TO_LIMIT,
+	CHAN_NODE_TORQUE_SATURATIONS,
+	CHAN_NODE_POWER_FAULT,
+	CHAN_NODE_ACC_DERATE,
+	CHAN_NODE_LATENCY_QUEUE,
+	CHAN_NODE_LATENCY_SERIAL,
+	CHAN_NODE_LATENCY_PLANNING,
+	CHAN_NODE_LATENCY_MECHANICAL,
+	CHAN_NODE_LATENCY_P50,
+	CHAN_NODE_LATENCY_P95,
+	CHAN_NODE_LATENCY_COUNT
+};
+
+struct OutputChannel
+{
+	std::string		Name;
+	int				Node	= -1;		// -1 for channels that are not per node
+	ChannelField	Field	= CHAN_ERRORS_TOTAL;
+};
@@ -1,14 +1,69 @@
 #include "SCHubController.h"
 
-SCHubController::SCHubController()
+#include <chrono>
+#include <cmath>
+
+std::atomic<SCHubController*> SCHubController::_attnTarget{ nullptr };
+
+SCHubController::SCHubController(EventQueue& events) :
+	_events(events),
+	_topology(std::make_shared<NodeTopology>()),
+	_thermal(std::make_shared<ThermalReport>())
+{
+	for (size_t i = 0; i < MN_API_MAX_NODES; i++)
+	{
+		_controlModeRequest[i] = PROFILE_NO_AXIS;
+		_virtualLost[i] = 0;
+	}
+}
+
+void SCHubController::start(const std::string& statePrefix)
 {
-	initializePort();
-	homeMotors();
+	if (_started)
+		return;
+
+	_started = true;
+	_statePrefix = statePrefix;
+	_profiles.setPath(statePrefix + NODE_PROFILE_SUFFIX);
+	_warmStartCache.setPath(statePrefix + WARM_START_CACHE_SUFFIX);
+
+	// Missing on the first run, every node then gets a fresh profile
+	_profiles.load();
+
+	if (initializePort() == Status::SUCCESS)
+	{
+		rebuildTopology();
+		homeMotors();
+	}
+
+	// Also without a port, a Reconnect request is served by the supervisor
+	_supervising = true;
+	_supervisor = std::thread(&SCHubController::superviseTopology, this);
 }
 
 SCHubController::~SCHubController()
 {
-	_myMgr->PortsClose();
+	_supervising = false;
+	_supervisorWake.notify_all();
+
+	if (_supervisor.joinable())
+		_supervisor.join();
+
+	if (_portOpened)
+		saveWarmStartCache();
+
+	SCHubController* self = this;
+	_attnTarget.compare_exchange_strong(self, nullptr);
+
+	try
+	{
+		if (_myMgr != nullptr)
+			_myMgr->PortsClose();
+	}
+	catch (mnErr&)
+	{
+		// Nobody is left to read the queue at this point
+	}
 }
 
 int SCHubController::initializePort()
@@ -16,174 +71,1455 @@ int SCHubController::initializePort()
 	size_t portCount = 0;
 	std::vector<std::string> comHubPorts;
 
-	_myMgr = SysManager::Instance();
+	try
+	{
+		_myMgr = SysManager::Instance();
+
+		SysManager::FindComHubPorts(comHubPorts);
 
-	SysManager::FindComHubPorts(comHubPorts);
+		for (portCount = 0; portCount < comHubPorts.size() && portCount < NET_CONTROLLER_MAX; portCount++) {
+			_myMgr->ComHubPort(portCount, comHubPorts[portCount].c_str());
+		}
 
-	for (portCount = 0; portCount < comHubPorts.size() && portCount < NET_CONTROLLER_MAX; portCount++) {
-		_myMgr->ComHubPort(portCount, comHubPorts[portCount].c_str());
-	}
+		if (portCount == 0) {
+			reportError(EVENT_NO_NODE, OP_CONNECT, MN_ERR_PORT_PROBLEM, "No SC-Hub port found");
+			return Status::PORT_NOT_FOUND;
+		}
 
-	if (portCount < 0) {
-		return Status::PORT_NOT_FOUND;  //This terminates the main program
+		_myMgr->PortsOpen(portCount);
+
+		IPort& myPort = _myMgr->Ports(_portID);
+
+		_attnTarget = this;
+		myPort.Adv.Attn.AttnHandler(&SCHubController::onAttention);
+		myPort.Adv.Attn.Enable(true);
+	}
+	catch (mnErr& theErr)
+	{
+		reportError(EVENT_NO_NODE, OP_CONNECT, theErr);
+		return Status::ERROR_CONTROLLER;
 	}
-	
-	_myMgr->PortsOpen(portCount);
+
+	_portOpened = true;
 
 	return Status::SUCCESS;
 }
 
-int SCHubController::homeMotor(INode& theNode)
+int SCHubController::homeMotor(size_t iNode, bool warmStart)
 {
 	try
 	{
+		INode& theNode = axisNode(iNode);
+
+		// Homed or not, the node is disabled and its position may be redefined
+		_virtualLost[iNode] |= VIRTUAL_LOST_TARGET | VIRTUAL_LOST_OFFSET;
+
 		theNode.EnableReq(false);
 
 		_myMgr->Delay(200);
 
-		theNode.Status.AlertsClear();  // Clear Alerts on node 
-		theNode.Motion.NodeStopClear();	// Clear Nodestops on Node  				
-		theNode.EnableReq(true);  // Enable node 
+		theNode.Status.AlertsClear();  // Clear Alerts on node
+		theNode.Motion.NodeStopClear();	// Clear Nodestops on Node
+		theNode.EnableReq(true);  // Enable node
 
-		double timeout = _myMgr->TimeStampMsec() + DEFAULT_TIME_TILL_TIMEOUT;
+		double timeout = _myMgr->TimeStampMsec() + _timeoutMsec;
 
 		while (!theNode.Motion.IsReady()) {
 			if (_myMgr->TimeStampMsec() > timeout) {
+				reportError((int32_t)iNode, OP_HOME, MN_ERR_TIMEOUT, "Node did not become ready");
 				return Status::TIMEOUT;
 			}
 		}
 
+		if (warmStart)
+		{
+			reportError((int32_t)iNode, OP_HOME, MN_OK, "Warm start, homing skipped");
+		}
 		// Check if the node has valid homing setup
-		if (theNode.Motion.Homing.HomingValid())
+		else if (theNode.Motion.Homing.HomingValid())
 		{
 			theNode.Motion.Homing.Initiate();
 
-			timeout = _myMgr->TimeStampMsec() + DEFAULT_TIME_TILL_TIMEOUT;	//define a timeout in case the node is unable to enable
+			timeout = _myMgr->TimeStampMsec() + _timeoutMsec;	//define a timeout in case the node is unable to enable
 																	// Basic mode - Poll until disabled
 			while (!theNode.Motion.Homing.WasHomed()) {
 				if (_myMgr->TimeStampMsec() > timeout) {
-					//printf("Node did not complete homing:  \n\t -Ensure Homing settings have been defined through ClearView. \n\t -Check for alerts/Shutdowns \n\t -Ensure timeout is longer than the longest possible homing move.\n");
-					//msgUser("Press any key to continue."); //pause so the user can see the error message; waits for user to press a key
+					reportError((int32_t)iNode, OP_HOME, MN_ERR_TIMEOUT, "Node did not complete homing");
 					return Status::HOMING_TIMEOUT;
 				}
 			}
+
+			recordHoming(theNode);
 		}
 		else {
-			//printf("Node[%d] has not had homing setup through ClearView.  The node will not be homed.\n", iNode);
+			reportError((int32_t)iNode, OP_HOME, MN_OK, "Homing not set up through ClearView, node not homed");
 		}
 
 		theNode.Motion.MoveWentDone();  // Clear the rising edge Move done register
 	}
 	catch (mnErr& theErr)
 	{
-		//printf("Failed to disable Nodes n\n");
-		//This statement will print the address of the error, the error code (defined by the mnErr class), 
-		//as well as the corresponding error message.
-		//printf("Caught error: addr=%d, err=0x%08x\nmsg=%s\n", theErr.TheAddr, theErr.ErrorCode, theErr.ErrorMsg);
-
-		//msgUser("Press any key to continue."); //pause so the user can see the error message; waits for user to press a key
-		return Status::ERROR_CONTROLLER;  //This terminates the main program
+		reportError((int32_t)iNode, OP_HOME, theErr);
+		return Status::ERROR_CONTROLLER;
 	}
 
 	return Status::SUCCESS;
 }
 
-void SCHubController::homeMotors()
+void SCHubController::homeMotors(bool allowWarmStart)
 {
-	IPort& myPort = _myMgr->Ports(_portID);
+	Uint16 nodeCount = getNodeCount();
+
+	_warmStartCache.load();
 
-	for (size_t i = 0; i < myPort.NodeCount(); i++)
+	// Nodes are homed one after another and nothing feeds the others meanwhile, so no watchdog may run
 	{
-		INode& theNode = myPort.Nodes(i);
-		homeMotor(theNode);
+		std::lock_guard<std::mutex> lock(_transactMutex);
+
+		for (size_t i = 0; i < nodeCount && i < MN_API_MAX_NODES; i++)
+		{
+			try
+			{
+				applyNetWatchdog(axisNode(i), 0.0);
+			}
+			catch (mnErr& theErr)
+			{
+				reportError((int32_t)i, OP_CONNECT, theErr);
+			}
+		}
 	}
+
+	for (size_t i = 0; i < nodeCount && i < MN_API_MAX_NODES; i++)
+	{
+		bool warmStart = false;
+
+		{
+			// Waits out a cycle already on the bus; every later one skips this axis until it is done
+			std::lock_guard<std::mutex> lock(_transactMutex);
+			_homingAxis = (int)i;
+		}
+
+		try
+		{
+			warmStart = allowWarmStart && canWarmStart(axisNode(i));
+		}
+		catch (mnErr& theErr)
+		{
+			reportError((int32_t)i, OP_HOME, theErr);
+		}
+
+		_warmStarted[i] = homeMotor(i, warmStart) == Status::SUCCESS && warmStart;
+	}
+
+	_homingAxis = -1;
+	_netWatchdogChanged = true;
+
+	// Soft limits only count once a node is homed, the table was read before
+	rereadLimits();
+
+	_warmStartCache.save();
+	_warmStartSavedMsec = timeStampMsec();
+}
+
+bool SCHubController::canWarmStart(INode& theNode)
+{
+	// The drive forgets its home on power loss, anything else is checked against what we left behind
+	if (!theNode.Motion.Homing.WasHomed())
+		return false;
+
+	const WarmStartEntry* entry = _warmStartCache.find(uint32_t(theNode.Info.SerialNumber));
+
+	if (entry == nullptr)
+		return false;
+
+	// The token ties the node to the homing we recorded, not one done since through ClearView or another host
+	std::vector<uint8_t> userData = theNode.Info.UserData(WARM_START_USER_DATA_BANK);
+	uint32_t token = 0;
+
+	if (userData.size() < 6 || userData[0] != 'W' || userData[1] != 'S')
+		return false;
+
+	for (size_t i = 0; i < 4; i++)
+		token |= uint32_t(userData[2 + i]) << (8 * i);
+
+	if (token != entry->Token)
+		return false;
+
+	theNode.Motion.PosnMeasured.Refresh();
+
+	return std::abs(theNode.Motion.PosnMeasured.Value() - entry->Position) <= WARM_START_POS_TOLERANCE_CNTS;
 }
 
-void SCHubController::enableMotor(size_t iNode, bool newState)
+void SCHubController::recordHoming(INode& theNode)
 {
-	IPort& myPort = _myMgr->Ports(_portID);
+	uint32_t serialNumber = uint32_t(theNode.Info.SerialNumber);
+	uint32_t token = uint32_t(std::chrono::system_clock::now().time_since_epoch().count()) ^ serialNumber;
 
-	// Once the code gets past this point, it can be assumed that the Port has been opened without issue
-	// Now we can get a reference to our port object which we will use to access the node objects
+	uint8_t userData[MN_USER_NV_SIZE] = { 'W', 'S' };
 
-	INode& theNode = myPort.Nodes(iNode);
+	for (size_t i = 0; i < 4; i++)
+		userData[2 + i] = uint8_t(token >> (8 * i));
 
-	theNode.EnableReq(newState);
+	theNode.Info.UserData(WARM_START_USER_DATA_BANK, userData);
+
+	theNode.Motion.PosnMeasured.Refresh();
+	_warmStartCache.update(serialNumber, token, theNode.Motion.PosnMeasured.Value());
 }
 
-bool SCHubController::enableMotor(size_t iNode)
+void SCHubController::saveWarmStartCache()
 {
-	IPort& myPort = _myMgr->Ports(_portID);
-	INode& theNode = myPort.Nodes(iNode);
+	try
+	{
+		IPort& myPort = _myMgr->Ports(_portID);
+
+		if (myPort.OpenState() != OPENED_ONLINE)
+			return;
+
+		for (size_t i = 0; i < myPort.NodeCount(); i++)
+		{
+			INode& theNode = myPort.Nodes(i);
+
+			// A node that lost its home must not be warm-started from a stale entry
+			if (!theNode.Motion.Homing.WasHomed())
+				continue;
+
+			theNode.Motion.PosnMeasured.Refresh();
+			_warmStartCache.updatePosition(uint32_t(theNode.Info.SerialNumber), theNode.Motion.PosnMeasured.Value());
+		}
+	}
+	catch (mnErr& theErr)
+	{
+		reportError(EVENT_NO_NODE, OP_HOME, theErr);
+		return;
+	}
 
-	return theNode.EnableReq();
+	if (!_warmStartCache.save())
+		reportError(EVENT_NO_NODE, OP_HOME, MN_ERR_FAIL, "Could not write warm start cache");
+
+	_warmStartSavedMsec = timeStampMsec();
 }
 
-int SCHubController::rotateMotor(size_t iNode, int32_t distanceCnts, double velLimit, double accLimit)
+void SCHubController::rebuildTopology()
 {
+	std::shared_ptr<const NodeTopology> current = getTopology();
+	std::shared_ptr<NodeTopology> next = std::make_shared<NodeTopology>();
+
+	next->Generation = current->Generation + 1;
+	_topologyStale = true;
+
 	try
 	{
 		IPort& myPort = _myMgr->Ports(_portID);
-		INode& theNode = myPort.Nodes(iNode);
 
-		//if (!theNode.Motion.MoveIsDone())
-		//	return Status::BUSY;
+		next->PortState = myPort.OpenState();
+
+		if (next->PortState == OPENED_ONLINE)
+		{
+			next->NodeCount = myPort.NodeCount();
+
+			if (next->NodeCount > MN_API_MAX_NODES)
+				next->NodeCount = MN_API_MAX_NODES;
+
+			NodeProfile* axisProfile[MN_API_MAX_NODES] = {};
+			assignAxes(myPort, next->NodeCount, next->AxisNode, axisProfile);
+
+			for (size_t i = 0; i < next->NodeCount; i++)
+			{
+				INode& theNode = myPort.Nodes(next->AxisNode[i]);
+				NodeProfile& profile = *axisProfile[i];
 
-		theNode.VelUnit(INode::RPM);
-		theNode.Motion.VelLimit = velLimit;
-		theNode.AccUnit(INode::RPM_PER_SEC);
-		theNode.Motion.AccLimit = accLimit;
+				// Settings are pushed once per connection, a node that stayed online keeps what it has
+				bool stayedOnline = false;
 
-		theNode.Motion.MovePosnStart(distanceCnts, true);
+				for (size_t j = 0; j < current->NodeCount && current->PortState == OPENED_ONLINE; j++)
+					stayedOnline |= current->SerialNumber[j] == profile.SerialNumber;
+
+				if (!stayedOnline)
+				{
+					applyProfile(i, theNode, profile);
+					_virtualLost[i] |= VIRTUAL_LOST_TARGET | VIRTUAL_LOST_OFFSET;
+
+					// Armed by the supervisor, after any homing that follows this rebuild
+					_netWatchdogChanged = true;
+				}
+
+				next->SerialNumber[i] = profile.SerialNumber;
+				next->PositioningResolution[i] = uint32_t(theNode.Info.PositioningResolution);
+				next->IsAdvanced[i] = theNode.Info.NodeType() == IInfo::CLEARPATH_SC_ADV;
+				next->CaptureOnRise[i] = theNode.Setup.Ex.HW.Value().cpm.CapturePolarityHiSpd != 0;
+				next->Profile[i] = profile;
+				next->Units[i] = makeAxisUnits(next->PositioningResolution[i], profile);
+
+				readLimits(theNode, next->Limits[i]);
+
+				// Power events are the node-side hint that the ring may have changed
+				if (next->IsAdvanced[i])
+				{
+					mnStatusReg attnMask;
+					attnMask.cpm.PowerEvent = 1;
+					theNode.Adv.Attn.Mask = attnMask;
+				}
+			}
+		}
+
+		_topologyStale = false;
 	}
 	catch (mnErr& theErr)
 	{
-		//printf("Failed to disable Nodes n\n");
-		//This statement will print the address of the error, the error code (defined by the mnErr class), 
-		//as well as the corresponding error message.
-		//printf("Caught error: addr=%d, err=0x%08x\nmsg=%s\n", theErr.TheAddr, theErr.ErrorCode, theErr.ErrorMsg);
+		reportError(EVENT_NO_NODE, OP_TOPOLOGY, theErr);
+	}
+
+	// Profiles assigned before a failure are kept, the retry finds them by serial number
+	if (_profilesDirty)
+	{
+		if (!_profiles.save())
+			reportError(EVENT_NO_NODE, OP_TOPOLOGY, MN_ERR_FAIL, "Could not write node profiles");
 
-		//msgUser("Press any key to continue."); //pause so the user can see the error message; waits for user to press a key
-		return Status::ERROR_CONTROLLER;  //This terminates the main program
+		_profilesDirty = false;
 	}
 
-	return Status::SUCCESS;
+	// A half-read table is never published, the current one stays until the next poll retries
+	if (_topologyStale)
+		return;
+
+	std::atomic_store(&_topology, std::shared_ptr<const NodeTopology>(next));
+
+	char message[EVENT_MESSAGE_LEN];
+	snprintf(message, sizeof(message), "Topology %u: %u node(s), port state %d",
+		next->Generation, (unsigned)next->NodeCount, (int)next->PortState);
+	reportError(EVENT_NO_NODE, OP_TOPOLOGY, MN_OK, message);
+}
+
+void SCHubController::assignAxes(IPort& myPort, Uint16 nodeCount, Uint16 axisNode[], NodeProfile* axisProfile[])
+{
+	NodeProfile* nodeProfile[MN_API_MAX_NODES] = {};
+	uint32_t serialNumber[MN_API_MAX_NODES] = {};
+	std::string userID[MN_API_MAX_NODES];
+
+	// Serial numbers win over UserIDs so a renamed drive never steals another one's profile
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		INode& theNode = myPort.Nodes(i);
+
+		serialNumber[i] = uint32_t(theNode.Info.SerialNumber);
+		userID[i] = theNode.Info.UserID.Value();
+		nodeProfile[i] = _profiles.findBySerial(serialNumber[i]);
+	}
+
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		if (nodeProfile[i] != nullptr)
+			continue;
+
+		NodeProfile* profile = _profiles.findByUserID(userID[i]);
+
+		for (size_t j = 0; j < nodeCount && profile != nullptr; j++)
+		{
+			if (nodeProfile[j] == profile)
+				profile = nullptr;
+		}
+
+		if (profile != nullptr)
+		{
+			// A replacement drive takes over the axis and gets the stored configuration loaded
+			profile->SerialNumber = serialNumber[i];
+			profile->ConfigHash = 0;
+		}
+		else
+		{
+			NodeProfile fresh;
+			fresh.SerialNumber = serialNumber[i];
+			fresh.UserID = userID[i];
+
+			// Keep what the drive was set up with in ClearView as its reference configuration
+			try
+			{
+				std::string configFile = _statePrefix + "." + std::to_string(serialNumber[i]) + ".mtr";
+
+				myPort.Nodes(i).Setup.ConfigSave(configFile.c_str());
+
+				fresh.ConfigFile = configFile;
+				fresh.ConfigHash = hashFile(configFile.c_str());
+			}
+			catch (mnErr& theErr)
+			{
+				reportError((int32_t)i, OP_TOPOLOGY, theErr);
+			}
+
+			profile = &_profiles.add(fresh);
+		}
+
+		nodeProfile[i] = profile;
+		_profilesDirty = true;
+	}
+
+	bool axisTaken[MN_API_MAX_NODES] = {};
+	bool nodePlaced[MN_API_MAX_NODES] = {};
+
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		NodeProfile* profile = nodeProfile[i];
+
+		if (profile->UserID != userID[i])
+		{
+			profile->UserID = userID[i];
+			_profilesDirty = true;
+		}
+
+		if (profile->Axis >= 0 && profile->Axis < nodeCount && !axisTaken[profile->Axis])
+		{
+			axisTaken[profile->Axis] = true;
+			axisNode[profile->Axis] = (Uint16)i;
+			axisProfile[profile->Axis] = profile;
+			nodePlaced[i] = true;
+		}
+	}
+
+	// Nodes without a usable axis fill the gaps in bus order
+	size_t freeAxis = 0;
+
+	for (size_t i = 0; i < nodeCount; i++)
+	{
+		if (nodePlaced[i])
+			continue;
+
+		while (axisTaken[freeAxis])
+			freeAxis++;
+
+		axisTaken[freeAxis] = true;
+		axisNode[freeAxis] = (Uint16)i;
+		axisProfile[freeAxis] = nodeProfile[i];
+
+		nodeProfile[i]->Axis = (int32_t)freeAxis;
+		_profilesDirty = true;
+	}
 }
 
-double SCHubController::getMeasuredPos(size_t iNode)
+static bool settingDiffers(double driveValue, double profileValue)
 {
-	IPort& myPort = _myMgr->Ports(_portID);
-	INode& theNode = myPort.Nodes(iNode);
+	return profileValue != PROFILE_UNSET && std::abs(driveValue - profileValue) > 1e-3 * (1.0 + std::abs(profileValue));
+}
+
+void SCHubController::applyProfile(size_t iAxis, INode& theNode, NodeProfile& profile)
+{
+	int applied = 0;
+
+	// Only reload the configuration when the file changed since it was last loaded, it is by far the slowest step
+	if (!profile.ConfigFile.empty())
+	{
+		uint64_t hash = hashFile(profile.ConfigFile.c_str());
+
+		if (hash != 0 && hash != profile.ConfigHash)
+		{
+			bool wasEnabled = theNode.EnableReq();
+
+			theNode.EnableReq(false);
+			theNode.Setup.ConfigLoad(profile.ConfigFile.c_str());
+			theNode.EnableReq(wasEnabled);
+
+			profile.ConfigHash = hash;
+			_profilesDirty = true;
+			applied++;
+		}
+	}
+
+	theNode.VelUnit(INode::RPM);
+	theNode.TrqUnit(INode::PCT_MAX);
+
+	if (settingDiffers(theNode.Limits.MotorSpeedLimit.Value(), profile.MaxVelRpm))
+	{
+		theNode.Limits.MotorSpeedLimit = profile.MaxVelRpm;
+		applied++;
+	}
 
-	theNode.Motion.PosnMeasured.AutoRefresh(true);
-	double pos = theNode.Motion.PosnMeasured;
-	return pos;
+	if (settingDiffers(theNode.Limits.TrqGlobal.Value(), profile.TrqGlobalPct))
+	{
+		theNode.Limits.TrqGlobal = profile.TrqGlobalPct;
+		applied++;
+	}
+
+	char message[EVENT_MESSAGE_LEN];
+	snprintf(message, sizeof(message), "Profile of serial %u, %d setting(s) applied", profile.SerialNumber, applied);
+	reportError((int32_t)iAxis, OP_TOPOLOGY, MN_OK, message);
 }
 
-double SCHubController::getMeasuredVel(size_t iNode)
+INode& SCHubController::axisNode(size_t iAxis)
 {
-	IPort& myPort = _myMgr->Ports(_portID);
-	INode& theNode = myPort.Nodes(iNode);
+	std::shared_ptr<const NodeTopology> topology = getTopology();
 
-	theNode.Motion.VelMeasured.AutoRefresh(true);
-	double vel = theNode.Motion.VelMeasured;
-	return vel;
+	// Past the table the bus index is passed through, so the port reports the bad index itself
+	return _myMgr->Ports(_portID).Nodes(iAxis < topology->NodeCount ? topology->AxisNode[iAxis] : iAxis);
 }
 
-double SCHubController::getMeasuredTrq(size_t iNode)
+void SCHubController::readLimits(INode& theNode, NodeLimits& limits)
 {
-	IPort& myPort = _myMgr->Ports(_portID);
-	INode& theNode = myPort.Nodes(iNode);
+	// Same units rotateMotor commands in
+	theNode.VelUnit(INode::RPM);
+	theNode.AccUnit(INode::RPM_PER_SEC);
 	theNode.TrqUnit(INode::PCT_MAX);
 
-	theNode.Motion.TrqMeasured.AutoRefresh(true);
-	double trq = theNode.Motion.TrqMeasured;
-	return trq;
+	limits.MaxVelRpm = theNode.Limits.MotorSpeedLimit.Value();
+	limits.TrqGlobalPct = theNode.Limits.TrqGlobal.Value();
+
+	int32_t softLimit1 = int32_t(theNode.Limits.SoftLimit1);
+	int32_t softLimit2 = int32_t(theNode.Limits.SoftLimit2);
+
+	limits.SoftLimitsActive = softLimit1 != softLimit2 && theNode.Motion.Homing.WasHomed();
+	limits.SoftLimitMin = softLimit1 < softLimit2 ? softLimit1 : softLimit2;
+	limits.SoftLimitMax = softLimit1 < softLimit2 ? softLimit2 : softLimit1;
+
+	limits.JerkDelayMsec = theNode.Motion.JrkLimitDelay.Value();
+
+	limits.Valid = true;
 }
 
-Uint16 SCHubController::getNodeCount()
+void SCHubController::rereadLimits()
+{
+	std::shared_ptr<const NodeTopology> current = getTopology();
+	std::shared_ptr<NodeTopology> next = std::make_shared<NodeTopology>(*current);
+
+	{
+		std::lock_guard<std::mutex> lock(_transactMutex);
+
+		for (size_t i = 0; i < next->NodeCount && next->PortState == OPENED_ONLINE; i++)
+		{
+			try
+			{
+				readLimits(_myMgr->Ports(_portID).Nodes(next->AxisNode[i]), next->Limits[i]);
+			}
+			catch (mnErr& theErr)
+			{
+				reportError((int32_t)i, OP_TOPOLOGY, theErr);
+			}
+		}
+	}
+
+	next->Generation = current->Generation + 1;
+	std::atomic_store(&_topology, std::shared_ptr<const NodeTopology>(next));
+}
+
+void SCHubController::superviseTopology()
 {
-	IPort& myPort = _myMgr->Ports(_portID);
+	while (_supervising)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_supervisorMutex);
+			_supervisorWake.wait_for(lock, std::chrono::duration<double, std::milli>(supervisorPollMsec()),
+				[this] { return !_supervising || _attnPending || _homeRequested || _reconnectRequested; });
+		}
+
+		if (!_supervising)
+			break;
+
+		if (_reconnectRequested.exchange(false))
+		{
+			reconnect();
+			continue;
+		}
+
+		bool home = _homeRequested.exchange(false);
+
+		if (!_portOpened)
+			continue;
+
+		if (home)
+		{
+			_homing = true;
+			homeMotors(false);
+			_homing = false;
+		}
+
+		if (_controlModeChanged.exchange(false))
+			applyControlModes();
+
+		bool rebuild = _attnPending.exchange(false) || _topologyStale;
+
+		try
+		{
+			// OpenState is host-side bookkeeping and costs no bus traffic
+			if (_myMgr->Ports(_portID).OpenState() != getTopology()->PortState)
+				rebuild = true;
+		}
+		catch (mnErr& theErr)
+		{
+			reportError(EVENT_NO_NODE, OP_TOPOLOGY, theErr);
+		}
+
+		if (rebuild)
+			rebuildTopology();
+
+		if (_netWatchdogChanged.exchange(false))
+			armNetWatchdogs();
+
+		if (_thermalMonitoring && timeStampMsec() - _thermalSampledMsec >= THERMAL_POLL_MSEC)
+			sampleThermal();
+
+		// The cook has gone quiet, on purpose or because nothing pulls it, feed the watchdogs and watch the status in its place
+		if ((_keepAlive || _netWatchdogMsec > 0.0) && timeStampMsec() - _lastTransactMsec >= supervisorPollMsec())
+			keepAlive();
+
+		// Keep the cached positions fresh enough that a crash still leaves a usable warm start
+		if (timeStampMsec() - _warmStartSavedMsec >= WARM_START_SAVE_MSEC)
+			saveWarmStartCache();
+	}
+}
+
+double SCHubController::supervisorPollMsec()
+{
+	double watchdogMsec = _netWatchdogMsec;
+	double pollMsec = _topologyPollMsec;
+
+	if (watchdogMsec > 0.0 && watchdogMsec * KEEP_ALIVE_FRACTION < pollMsec)
+		return watchdogMsec * KEEP_ALIVE_FRACTION;
+
+	return pollMsec;
+}
+
+void SCHubController::reconnect()
+{
+	_homing = true;
+
+	{
+		// No cycle may be on the bus while the port goes away
+		std::lock_guard<std::mutex> lock(_transactMutex);
+		_portOpened = false;
+	}
+
+	try
+	{
+		if (_myMgr != nullptr)
+			_myMgr->PortsClose();
+	}
+	catch (mnErr& theErr)
+	{
+		reportError(EVENT_NO_NODE, OP_CONNECT, theErr);
+	}
+
+	if (initializePort() == Status::SUCCESS)
+	{
+		rebuildTopology();
+		homeMotors();
+	}
+	else
+	{
+		std::shared_ptr<NodeTopology> next = std::make_shared<NodeTopology>();
+		next->Generation = getTopology()->Generation + 1;
+		std::atomic_store(&_topology, std::shared_ptr<const NodeTopology>(next));
+	}
+
+	_homing = false;
+}
+
+void SCHubController::applyControlModes()
+{
+	std::shared_ptr<const NodeTopology> current = getTopology();
+	std::shared_ptr<NodeTopology> next = std::make_shared<NodeTopology>(*current);
+	bool changed = false;
+
+	for (size_t i = 0; i < MN_API_MAX_NODES; i++)
+	{
+		int mode = _controlModeRequest[i].exchange(PROFILE_NO_AXIS);
+
+		if (mode == PROFILE_NO_AXIS || i >= next->NodeCount || mode == next->Profile[i].ControlMode)
+			continue;
+
+		// Kept with the node's profile, so the mode follows the drive to whichever axis it ends up on
+		NodeProfile* profile = _profiles.findBySerial(next->SerialNumber[i]);
+
+		if (profile != nullptr)
+		{
+			profile->ControlMode = (AxisControlMode)mode;
+			_profilesDirty = true;
+		}
+
+		next->Profile[i].ControlMode = (AxisControlMode)mode;
+		changed = true;
+	}
+
+	if (!changed)
+		return;
+
+	if (_profilesDirty)
+	{
+		if (!_profiles.save())
+			reportError(EVENT_NO_NODE, OP_TOPOLOGY, MN_ERR_FAIL, "Could not write node profiles");
 
-	return myPort.NodeCount();
+		_profilesDirty = false;
+	}
+
+	next->Generation = current->Generation + 1;
+	std::atomic_store(&_topology, std::shared_ptr<const NodeTopology>(next));
+}
+
+void SCHubController::keepAlive()
+{
+	std::shared_ptr<const NodeTopology> topology = getTopology();
+
+	if (topology->PortState != OPENED_ONLINE)
+		return;
+
+	NodeTransaction transactions[MN_API_MAX_NODES];
+
+	for (size_t i = 0; i < topology->NodeCount; i++)
+		transactions[i].Heartbeat = true;
+
+	transactAll(transactions, topology->NodeCount);
+}
+
+void SCHubController::sampleThermal()
+{
+	std::shared_ptr<const NodeTopology> topology = getTopology();
+	std::shared_ptr<ThermalReport> report = std::make_shared<ThermalReport>();
+
+	_thermalSampledMsec = timeStampMsec();
+
+	if (topology->PortState != OPENED_ONLINE)
+		return;
+
+	for (size_t i = 0; i < topology->NodeCount; i++)
+	{
+		ThermalState& state = _thermalState[i];
+
+		// A different node on this axis starts its model from scratch
+		if (_thermalSerial[i] != topology->SerialNumber[i])
+		{
+			state = ThermalState();
+			_thermalSerial[i] = topology->SerialNumber[i];
+		}
+
+		try
+		{
+			INode& theNode = _myMgr->Ports(_portID).Nodes(topology->AxisNode[i]);
+
+			theNode.Status.RMSlevel.Refresh();
+			theNode.Status.Power.Refresh();
+
+			mnPowerReg power = theNode.Status.Power.Value();
+
+			state.PowerFault = power.fld.InBusLoss || power.fld.InUnderOperV || power.fld.InWiringError;
+
+			if (theNode.Status.HadTorqueSaturation())
+				state.TorqueSaturations++;
+
+			state.update(timeStampMsec(), theNode.Status.RMSlevel.Value());
+		}
+		catch (mnErr& theErr)
+		{
+			reportError((int32_t)i, OP_TELEMETRY, theErr);
+		}
+
+		report->Axis[i] = state;
+	}
+
+	report->Sequence = getThermal()->Sequence + 1;
+
+	std::atomic_store(&_thermal, std::shared_ptr<const ThermalReport>(report));
+}
+
+void SCHubController::applyNetWatchdog(INode& theNode, double watchdogMsec)
+{
+	if (theNode.Setup.Ex.NetWatchdogMsec.Value() != watchdogMsec)
+		theNode.Setup.Ex.NetWatchdogMsec = watchdogMsec;
+}
+
+void SCHubController::armNetWatchdogs()
+{
+	std::shared_ptr<const NodeTopology> topology = getTopology();
+	std::lock_guard<std::mutex> lock(_transactMutex);
+
+	for (size_t i = 0; i < topology->NodeCount && topology->PortState == OPENED_ONLINE; i++)
+	{
+		try
+		{
+			applyNetWatchdog(_myMgr->Ports(_portID).Nodes(topology->AxisNode[i]), _netWatchdogMsec);
+		}
+		catch (mnErr& theErr)
+		{
+			reportError((int32_t)i, OP_CONNECT, theErr);
+		}
+
+		// Unwatched until now, a gap before this point stopped nothing
+		_heartbeat[i].restart(_myMgr->TimeStampMsec());
+	}
+}
+
+void nodeCallback SCHubController::onAttention(const mnAttnReqReg& detected)
+{
+	// Runs on an sFoundation thread where bus access is not allowed, only wake the supervisor
+	SCHubController* target = _attnTarget;
+
+	if (target != nullptr && detected.AttentionReg.cpm.PowerEvent)
+	{
+		target->_attnPending = true;
+		target->_supervisorWake.notify_all();
+	}
+}
+
+void SCHubController::reportError(int32_t iNode, EventOp op, const mnErr& theErr)
+{
+	_events.push(iNode, theErr.ErrorCode, op, timeStampMsec(), theErr.ErrorMsg);
+}
+
+void SCHubController::reportError(int32_t iNode, EventOp op, uint32_t errorCode, const char* message)
+{
+	_events.push(iNode, errorCode, op, timeStampMsec(), message);
+}
+
+int SCHubController::enableMotor(size_t iNode, bool newState)
+{
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+		return Status::PORT_NOT_FOUND;
+
+	if ((int)iNode == _homingAxis)
+		return Status::BUSY;
+
+	try
+	{
+		// Once the code gets past this point, it can be assumed that the Port has been opened without issue
+		// Now we can get a reference to the node driving this axis
+
+		INode& theNode = axisNode(iNode);
+
+		theNode.EnableReq(newState);
+		_virtualLost[iNode] |= VIRTUAL_LOST_TARGET;
+	}
+	catch (mnErr& theErr)
+	{
+		reportError((int32_t)iNode, OP_ENABLE, theErr);
+		return Status::ERROR_CONTROLLER;
+	}
+
+	return Status::SUCCESS;
+}
+
+int SCHubController::getEnableReq(size_t iNode, bool& isEnabled)
+{
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+		return Status::PORT_NOT_FOUND;
+
+	if ((int)iNode == _homingAxis)
+		return Status::BUSY;
+
+	try
+	{
+		INode& theNode = axisNode(iNode);
+
+		isEnabled = theNode.EnableReq();
+	}
+	catch (mnErr& theErr)
+	{
+		reportError((int32_t)iNode, OP_ENABLE, theErr);
+		return Status::ERROR_CONTROLLER;
+	}
+
+	return Status::SUCCESS;
+}
+
+int SCHubController::rotateMotor(size_t iNode, int64_t targetCnts, double velLimit, double accLimit)
+{
+	NodeTransaction transaction;
+
+	transaction.StartMove = true;
+	transaction.MoveVirtual = true;
+	transaction.VirtualTargetCnts = targetCnts;
+	transaction.VelLimit = velLimit;
+	transaction.AccLimit = accLimit;
+
+	return transact(iNode, transaction);
+}
+
+int SCHubController::readTelemetry(size_t iNode, TelemetrySample& sample, bool withCommanded)
+{
+	NodeTransaction transaction;
+
+	transaction.ReadTelemetry = true;
+	transaction.WithCommanded = withCommanded;
+
+	int result = transact(iNode, transaction);
+
+	if (result == Status::SUCCESS)
+		sample = transaction.Telemetry;
+
+	return result;
+}
+
+int SCHubController::readStatus(size_t iNode, StatusSnapshot& snapshot)
+{
+	NodeTransaction transaction;
+
+	transaction.ReadStatus = true;
+
+	int result = transact(iNode, transaction);
+
+	if (result == Status::SUCCESS)
+		snapshot = transaction.Status;
+
+	return result;
+}
+
+int SCHubController::transact(size_t iNode, NodeTransaction& transaction)
+{
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+		return transaction.Result = Status::PORT_NOT_FOUND;
+
+	if ((int)iNode == _homingAxis)
+		return transaction.Result = Status::BUSY;
+
+	try
+	{
+		transaction.Result = runTransaction(iNode, axisNode(iNode), *getTopology(), transaction);
+	}
+	catch (mnErr& theErr)
+	{
+		reportError((int32_t)iNode, OP_TELEMETRY, theErr);
+		transaction.Result = Status::ERROR_CONTROLLER;
+	}
+
+	return transaction.Result;
+}
+
+std::unique_lock<std::mutex> SCHubController::lockOpenPort()
+{
+	std::unique_lock<std::mutex> lock(_transactMutex);
+
+	// Checked under the lock, a reconnect closes the port while holding it
+	if (!_portOpened)
+		lock.unlock();
+
+	return lock;
+}
+
+void SCHubController::transactAll(NodeTransaction* transactions, size_t count)
+{
+	if (!_portOpened)
+	{
+		for (size_t i = 0; i < count; i++)
+			transactions[i].Result = Status::PORT_NOT_FOUND;
+
+		return;
+	}
+
+	// Checked again under the lock, a reconnect may have closed the port meanwhile
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+	{
+		for (size_t i = 0; i < count; i++)
+			transactions[i].Result = Status::PORT_NOT_FOUND;
+
+		return;
+	}
+
+	// One table for the whole cycle, a remap can only take effect between cycles
+	std::shared_ptr<const NodeTopology> topology = getTopology();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		// Homing enables, waits on and redefines the node, it gets the bus to itself
+		if ((int)i == _homingAxis)
+		{
+			transactions[i].Result = Status::BUSY;
+			continue;
+		}
+
+		try
+		{
+			IPort& myPort = _myMgr->Ports(_portID);
+			INode& theNode = myPort.Nodes(i < topology->NodeCount ? topology->AxisNode[i] : i);
+
+			// Another node on this axis starts its statistics from scratch
+			if (i < MN_API_MAX_NODES && _heartbeatSerial[i] != topology->SerialNumber[i])
+			{
+				_heartbeat[i] = HeartbeatStats();
+				_heartbeatSerial[i] = topology->SerialNumber[i];
+			}
+
+			// Quiet for longer than its watchdog, the node has stopped itself; cleared before this cycle's move
+			if (i < MN_API_MAX_NODES && _heartbeat[i].expired(_myMgr->TimeStampMsec(), _netWatchdogMsec))
+			{
+				theNode.Motion.NodeStopClear();
+				_virtualLost[i] |= VIRTUAL_LOST_TARGET;
+				transactions[i].WatchdogTripped = true;
+			}
+
+			transactions[i].Result = runTransaction(i, theNode, *topology, transactions[i]);
+
+			if (transactions[i].Result == Status::SUCCESS && i < MN_API_MAX_NODES
+				&& _heartbeat[i].update(_myMgr->TimeStampMsec(), _netWatchdogMsec))
+			{
+				char message[EVENT_MESSAGE_LEN];
+				snprintf(message, sizeof(message), "Heartbeat gap of %.0f ms exceeded the %.0f ms watchdog",
+					_heartbeat[i].LastIntervalMsec, (double)_netWatchdogMsec);
+				reportError((int32_t)i, OP_TELEMETRY, MN_ERR_TIMEOUT, message);
+			}
+
+			if (transactions[i].Result == Status::SUCCESS && i < MN_API_MAX_NODES
+				&& (transactions[i].ReadStatus || transactions[i].Heartbeat)
+				&& transactions[i].Status.RT != _lastStatusRT[i])
+			{
+				_lastStatusRT[i] = transactions[i].Status.RT;
+				_statusChanges++;
+			}
+		}
+		catch (mnErr& theErr)
+		{
+			reportError((int32_t)i, OP_TELEMETRY, theErr);
+			transactions[i].Result = Status::ERROR_CONTROLLER;
+		}
+	}
+
+	_lastTransactMsec = _myMgr->TimeStampMsec();
+}
+
+int SCHubController::triggerGroup(size_t groupNumber)
+{
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+		return Status::PORT_NOT_FOUND;
+
+	try
+	{
+		// One broadcast starts every move loaded for this group
+		_myMgr->Ports(_portID).Adv.TriggerMovesInGroup(groupNumber);
+	}
+	catch (mnErr& theErr)
+	{
+		reportError(EVENT_NO_NODE, OP_MOVE, theErr);
+		return Status::ERROR_CONTROLLER;
+	}
+
+	return Status::SUCCESS;
+}
+
+static int32_t clampCounts(int64_t cnts)
+{
+	return cnts < INT32_MIN ? INT32_MIN : (cnts > INT32_MAX ? INT32_MAX : (int32_t)cnts);
+}
+
+VirtualAxis& SCHubController::virtualAxis(size_t iAxis, const NodeTopology& topology)
+{
+	VirtualAxis& axis = _virtual[iAxis];
+	uint32_t serialNumber = iAxis < topology.NodeCount ? topology.SerialNumber[iAxis] : 0;
+	uint32_t lost = _virtualLost[iAxis].exchange(0);
+
+	// Another node on this axis has a counter, and move registers, of its own
+	if ((lost & VIRTUAL_LOST_OFFSET) || axis.SerialNumber != serialNumber)
+	{
+		axis = VirtualAxis();
+		axis.SerialNumber = serialNumber;
+		_written[iAxis] = MoveRegisters();
+	}
+
+	if (lost & VIRTUAL_LOST_TARGET)
+		axis.TargetValid = false;
+
+	return axis;
+}
+
+void SCHubController::resolveVirtualMove(size_t iAxis, INode& theNode, const NodeTopology& topology, NodeTransaction& transaction)
+{
+	VirtualAxis& axis = _virtual[iAxis];
+	AxisControlMode mode = iAxis < topology.NodeCount ? topology.Profile[iAxis].ControlMode : CONTROL_ABSOLUTE;
+
+	// Whole turns are taken out of the drive's counter long before it could wrap, so the shaft angle it reports stays
+	// the same. AddToPosition shifts the measured and commanded position together, a move under way is not disturbed
+	if (mode == CONTROL_UNBOUNDED && axis.TargetValid)
+	{
+		int64_t driveTarget = axis.TargetCnts - axis.OffsetCnts;
+
+		if (driveTarget > VIRTUAL_FOLD_CNTS || driveTarget < -VIRTUAL_FOLD_CNTS)
+		{
+			int64_t countsPerRev = iAxis < topology.NodeCount && topology.PositioningResolution[iAxis] > 0
+				? topology.PositioningResolution[iAxis] : 1;
+			int64_t fold = driveTarget / countsPerRev * countsPerRev;
+
+			theNode.Motion.AddToPosition(double(-fold));
+			axis.OffsetCnts += fold;
+		}
+	}
+
+	// Absolute until the drive has taken a target the next one can be measured from
+	transaction.MoveRelative = mode != CONTROL_ABSOLUTE && axis.TargetValid;
+
+	if (transaction.MoveRelative)
+		transaction.MoveTargetCnts = clampCounts(transaction.VirtualTargetCnts - axis.TargetCnts);
+	else
+		transaction.MoveTargetCnts = clampCounts(transaction.VirtualTargetCnts - axis.OffsetCnts);
+}
+
+void SCHubController::writeMoveRegisters(size_t iAxis, INode& theNode, NodeTransaction& transaction)
+{
+	MoveRegisters& written = _written[iAxis];
+	const MoveProfile& profile = transaction.Profile;
+
+	theNode.VelUnit(INode::RPM);
+	theNode.AccUnit(INode::RPM_PER_SEC);
+
+	// The drive keeps every register until it is written again, each write is a round trip of its own
+	if (transaction.VelLimit != written.VelLimit)
+	{
+		theNode.Motion.VelLimit = transaction.VelLimit;
+		written.VelLimit = transaction.VelLimit;
+	}
+
+	if (transaction.AccLimit != written.AccLimit)
+	{
+		theNode.Motion.AccLimit = transaction.AccLimit;
+		written.AccLimit = transaction.AccLimit;
+	}
+
+	if (profile.JerkLimit != JERK_LIMIT_UNSET && profile.JerkLimit != written.JerkLimit)
+	{
+		theNode.Motion.JrkLimit = (uint32_t)profile.JerkLimit;
+		written.JerkLimit = profile.JerkLimit;
+
+		// The S-curve the drive settled on, for the duration model
+		theNode.Motion.JrkLimitDelay.Refresh();
+		transaction.JerkDelayMsec = theNode.Motion.JrkLimitDelay.Value();
+	}
+
+	if (profile.Type == MOVE_ASYMMETRIC && profile.DecLimit != written.DecLimit)
+	{
+		theNode.Motion.Adv.DecelLimit = profile.DecLimit;
+		written.DecLimit = profile.DecLimit;
+	}
+
+	if (profile.Type == MOVE_HEAD_TAIL)
+	{
+		if (profile.HeadCnts > 0 && profile.HeadCnts != written.HeadCnts)
+		{
+			theNode.Motion.Adv.HeadDistance = profile.HeadCnts;
+			written.HeadCnts = profile.HeadCnts;
+		}
+
+		if (profile.TailCnts > 0 && profile.TailCnts != written.TailCnts)
+		{
+			theNode.Motion.Adv.TailDistance = profile.TailCnts;
+			written.TailCnts = profile.TailCnts;
+		}
+
+		if (profile.HeadTailVelLimit != written.HeadTailVelLimit)
+		{
+			theNode.Motion.Adv.HeadTailVelLimit = profile.HeadTailVelLimit;
+			written.HeadTailVelLimit = profile.HeadTailVelLimit;
+		}
+	}
+}
+
+int SCHubController::runTransaction(size_t iAxis, INode& theNode, const NodeTopology& topology, NodeTransaction& transaction)
+{
+	EventOp op = OP_TELEMETRY;
+
+	try
+	{
+		INode::UseMutex lock(theNode);
+
+		VirtualAxis& axis = virtualAxis(iAxis, topology);
+		double offset = double(axis.OffsetCnts);
+
+		if (transaction.SelectAudit != AUDIT_OFF)
+		{
+			if (transaction.SelectAudit == AUDIT_TRACKING)
+				theNode.Adv.MotionAudit.SelectTestPoint(IMotionAudit::MON_POS_TRK, AUDIT_FULL_SCALE_TRACKING_CNTS, AUDIT_FILTER_MSEC);
+			else if (transaction.SelectAudit == AUDIT_TORQUE_MEASURED)
+				theNode.Adv.MotionAudit.SelectTestPoint(IMotionAudit::MON_TRQ_MEAS, AUDIT_FULL_SCALE_TORQUE_PCT, AUDIT_FILTER_MSEC);
+			else
+				theNode.Adv.MotionAudit.SelectTestPoint(IMotionAudit::MON_TRQ_CMD, AUDIT_FULL_SCALE_TORQUE_PCT, AUDIT_FILTER_MSEC);
+		}
+
+		if (transaction.Heartbeat && !transaction.ReadStatus && !transaction.ReadTelemetry && !transaction.StartMove)
+		{
+			// Any exchange resets the node's watchdog, a single real-time status read is the cheapest
+			theNode.Status.RT.AutoRefresh(false);
+			theNode.Status.RT.Refresh();
+
+			transaction.Status.RT = theNode.Status.RT.Value().attnBits;
+		}
+
+		if (transaction.ReadStatus)
+		{
+			theNode.Status.RT.AutoRefresh(false);
+			theNode.Status.Rise.AutoRefresh(false);
+			theNode.Status.Fall.AutoRefresh(false);
+			theNode.Status.Accum.AutoRefresh(false);
+
+			theNode.Status.RT.Refresh();
+			theNode.Status.Rise.Refresh();
+			theNode.Status.Fall.Refresh();
+			theNode.Status.Accum.Refresh();
+
+			transaction.Status.RT = theNode.Status.RT.Value().attnBits;
+			transaction.Status.Rise = theNode.Status.Rise.Value().attnBits;
+			transaction.Status.Fall = theNode.Status.Fall.Value().attnBits;
+			transaction.Status.Accum = theNode.Status.Accum.Value().attnBits;
+
+			// A node that is disabled, or was just enabled again, has no move left to be relative to
+			uint32_t enabled = 1u << statusFieldShift[STATUS_ENABLED];
+
+			if (!(transaction.Status.RT & enabled) || (transaction.Status.Rise & enabled))
+				axis.TargetValid = false;
+
+			// The latched registers OR-accumulate on the host, start the next cycle empty
+			theNode.Status.Rise.Clear();
+			theNode.Status.Fall.Clear();
+			theNode.Status.Accum.Clear();
+
+			// Only an edge the drive latches on is worth the two extra round trips
+			uint32_t edges = transaction.CaptureOnRise ? transaction.Status.Rise : transaction.Status.Fall;
+
+			transaction.Captured = transaction.ReadCapture && (edges & (1u << statusFieldShift[STATUS_IN_A])) != 0;
+
+			if (transaction.Captured)
+			{
+				theNode.Status.Adv.CapturedHiResPosn.AutoRefresh(false);
+				theNode.Status.Adv.CapturedPos.AutoRefresh(false);
+
+				theNode.Status.Adv.CapturedHiResPosn.Refresh();
+				theNode.Status.Adv.CapturedPos.Refresh();
+
+				transaction.CapturedHiResPos = int32_t(theNode.Status.Adv.CapturedHiResPosn) + offset;
+				transaction.CapturedPos = int32_t(theNode.Status.Adv.CapturedPos) + offset;
+			}
+
+			// Same edge MoveWentDone reports, taken from the Rise register already read this cycle
+			transaction.Audited = transaction.ReadAudit && (transaction.Status.Rise & (1u << statusFieldShift[STATUS_MOVE_DONE])) != 0;
+
+			if (transaction.Audited)
+			{
+				theNode.Adv.MotionAudit.Refresh();
+
+				const mnAuditData& results = theNode.Adv.MotionAudit.Results;
+
+				transaction.Audit.TimeMsec = _myMgr->TimeStampMsec();
+				transaction.Audit.LowPassRMS = results.LowPassRMS;
+				transaction.Audit.MaxPos = results.LowPassMaxPos;
+				transaction.Audit.MaxNeg = results.LowPassMaxNeg;
+				transaction.Audit.HighPassRMS = results.HighPassRMS;
+				transaction.Audit.DurationMsec = results.DurationMS;
+				transaction.Audit.MaxTrackingPos = (int32_t)results.MaxTrackingPos;
+				transaction.Audit.MaxTrackingNeg = (int32_t)results.MaxTrackingNeg;
+			}
+		}
+
+		if (transaction.ReadTelemetry)
+		{
+			TelemetrySample& sample = transaction.Telemetry;
+
+			theNode.VelUnit(INode::RPM);
+			theNode.TrqUnit(INode::PCT_MAX);
+
+			// Refresh explicitly so each register costs exactly one round trip
+			theNode.Motion.PosnMeasured.AutoRefresh(false);
+			theNode.Motion.VelMeasured.AutoRefresh(false);
+			theNode.Motion.TrqMeasured.AutoRefresh(false);
+
+			double sentMsec = _myMgr->TimeStampMsec();
+			theNode.Motion.PosnMeasured.Refresh();
+			double receivedMsec = _myMgr->TimeStampMsec();
+
+			if (transaction.ReadVelocity)
+			{
+				theNode.Motion.VelMeasured.Refresh();
+				sample.Vel = theNode.Motion.VelMeasured.Value();
+			}
+
+			if (transaction.ReadTorque)
+			{
+				theNode.Motion.TrqMeasured.Refresh();
+				sample.Trq = theNode.Motion.TrqMeasured.Value();
+			}
+
+			if (transaction.WithCommanded)
+			{
+				theNode.Motion.PosnCommanded.AutoRefresh(false);
+				theNode.Motion.PosnCommanded.Refresh();
+				sample.Commanded = theNode.Motion.PosnCommanded.Value() + offset;
+			}
+
+			sample.Pos = theNode.Motion.PosnMeasured.Value() + offset;
+			sample.TimeMsec = 0.5 * (sentMsec + receivedMsec);
+		}
+
+		if (transaction.StartMove)
+		{
+			op = OP_MOVE;
+
+			//if (!theNode.Motion.MoveIsDone())
+			//	return Status::BUSY;
+
+			if (transaction.MoveVirtual)
+				resolveVirtualMove(iAxis, theNode, topology, transaction);
+
+			// Until the move is known to be queued, the drive's last target is not
+			bool hadTarget = axis.TargetValid;
+			axis.TargetValid = false;
+
+			transaction.MoveStartMsec = _myMgr->TimeStampMsec();
+
+			writeMoveRegisters(iAxis, theNode, transaction);
+
+			// Kinematic limits are set above, so the drive answers for exactly this move
+			const MoveProfile& profile = transaction.Profile;
+			bool absolute = !transaction.MoveRelative;
+			bool hasHead = profile.HeadCnts > 0;
+			bool hasTail = profile.TailCnts > 0;
+
+			if (transaction.QueryDuration)
+			{
+				if (profile.Type == MOVE_ASYMMETRIC)
+					transaction.DriveDurationMsec = theNode.Motion.Adv.MovePosnAsymDurationMsec(transaction.MoveTargetCnts, absolute);
+				else if (profile.Type == MOVE_HEAD_TAIL)
+					transaction.DriveDurationMsec = theNode.Motion.Adv.MovePosnHeadTailDurationMsec(transaction.MoveTargetCnts, absolute, hasHead, hasTail);
+				else
+					transaction.DriveDurationMsec = theNode.Motion.MovePosnDurationMsec(transaction.MoveTargetCnts, absolute);
+			}
+
+			if (transaction.TriggerGroup > 0)
+				theNode.Motion.Adv.TriggerGroup((size_t)transaction.TriggerGroup);
+
+			if (profile.Type == MOVE_ASYMMETRIC)
+				theNode.Motion.Adv.MovePosnAsymStart(transaction.MoveTargetCnts, absolute, transaction.Triggered);
+			else if (profile.Type == MOVE_HEAD_TAIL)
+				theNode.Motion.Adv.MovePosnHeadTailStart(transaction.MoveTargetCnts, absolute, transaction.Triggered, hasHead, hasTail);
+			else if (transaction.Triggered)
+				theNode.Motion.Adv.MovePosnStart(transaction.MoveTargetCnts, absolute, true);
+			else
+				theNode.Motion.MovePosnStart(transaction.MoveTargetCnts, absolute);
+
+			transaction.MoveSentMsec = _myMgr->TimeStampMsec();
+
+			// A relative move counts from the end of the one queued before it, not from where the shaft is
+			axis.TargetCnts = absolute ? transaction.MoveTargetCnts + axis.OffsetCnts : axis.TargetCnts + transaction.MoveTargetCnts;
+			axis.TargetValid = absolute || hadTarget;
+		}
+	}
+	catch (mnErr& theErr)
+	{
+		reportError((int32_t)iAxis, op, theErr);
+		return Status::ERROR_CONTROLLER;
+	}
+
+	return Status::SUCCESS;
+}
+
+bool SCHubController::wasWarmStarted(size_t iNode)
+{
+	return iNode < MN_API_MAX_NODES && _warmStarted[iNode];
+}
+
+void SCHubController::setNetWatchdog(double watchdogMsec)
+{
+	if (watchdogMsec != _netWatchdogMsec)
+	{
+		_netWatchdogMsec = watchdogMsec;
+		_netWatchdogChanged = true;
+	}
+}
+
+HeartbeatStats SCHubController::getHeartbeat(size_t iNode)
+{
+	std::lock_guard<std::mutex> lock(_transactMutex);
+	return _heartbeat[iNode < MN_API_MAX_NODES ? iNode : 0];
+}
+
+void SCHubController::setKeepAlive(bool enabled)
+{
+	_keepAlive = enabled;
+}
+
+uint32_t SCHubController::getStatusChanges()
+{
+	return _statusChanges;
+}
+
+void SCHubController::setSupervisorPoll(double pollMsec)
+{
+	_topologyPollMsec = pollMsec > 1.0 ? pollMsec : 1.0;
+}
+
+void SCHubController::setHomingTimeout(double timeoutMsec)
+{
+	_timeoutMsec = timeoutMsec;
+}
+
+void SCHubController::setControlMode(size_t iNode, AxisControlMode mode)
+{
+	if (iNode >= MN_API_MAX_NODES)
+		return;
+
+	_controlModeRequest[iNode] = mode;
+	_controlModeChanged = true;
+}
+
+void SCHubController::requestHoming()
+{
+	_homeRequested = true;
+	_supervisorWake.notify_all();
+}
+
+void SCHubController::requestReconnect()
+{
+	_reconnectRequested = true;
+	_supervisorWake.notify_all();
+}
+
+bool SCHubController::isHoming()
+{
+	return _homing || _homeRequested || _reconnectRequested;
+}
+
+void SCHubController::stopAll()
+{
+	std::unique_lock<std::mutex> lock = lockOpenPort();
+
+	if (!lock)
+		return;
+
+	try
+	{
+		// One broadcast, every node ramps down at its own deceleration limit
+		_myMgr->Ports(_portID).NodeStop(STOP_TYPE_RAMP_AT_DECEL);
+		reportError(EVENT_NO_NODE, OP_MOVE, MN_OK, "Node stop sent to every node");
+
+		for (size_t i = 0; i < MN_API_MAX_NODES; i++)
+			_virtualLost[i] |= VIRTUAL_LOST_TARGET;
+	}
+	catch (mnErr& theErr)
+	{
+		reportError(EVENT_NO_NODE, OP_MOVE, theErr);
+	}
+}
+
+void SCHubController::setThermalMonitoring(bool enabled)
+{
+	_thermalMonitoring = enabled;
+}
+
+std::shared_ptr<const ThermalReport> SCHubController::getThermal()
+{
+	return std::atomic_load(&_thermal);
+}
+
+std::shared_ptr<const NodeTopology> SCHubController::getTopology()
+{
+	return std::atomic_load(&_topology);
+}
+
+Uint16 SCHubController::getNodeCount()
+{
+	std::shared_ptr<const NodeTopology> topology = getTopology();
+
+	return topology->PortState == OPENED_ONLINE ? topology->NodeCount : 0;
+}
+
+double SCHubController::timeStampMsec()
+{
+	return _myMgr != nullptr ? _myMgr->TimeStampMsec() : 0.0;
 }
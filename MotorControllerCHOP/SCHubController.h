@@ -1,11 +1,119 @@
 #pragma once
 
 #include "pubSysCls.h"
+#include "ControllerEvents.h"
+#include "NodeTopology.h"
+#include "MotionAuditLog.h"
+#include "MoveProfile.h"
+#include "NetWatchdog.h"
+#include "StatusSnapshot.h"
+#include "ThermalMonitor.h"
+#include "WarmStartCache.h"
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 using namespace sFnd;
 
 #define DEFAULT_ACC_LIM_RPM_PER_SEC 100000
 #define DEFAULT_VEL_LIM_RPM         700
 #define DEFAULT_TIME_TILL_TIMEOUT   10000
+#define TOPOLOGY_POLL_MSEC          250
+#define VIRTUAL_FOLD_CNTS           (int64_t(1) << 30)	// Drive position an unbounded axis is folded back from
+#define VIRTUAL_LOST_TARGET         1u	// The drive dropped its moves, the next target goes absolute
+#define VIRTUAL_LOST_OFFSET         2u	// The drive's counter starts over, nothing folded before applies
+
+struct TelemetrySample
+{
+	double	Pos			= 0.0;	// Counts
+	double	Vel			= 0.0;	// RPM
+	double	Trq			= 0.0;	// Percent of drive maximum
+	double	Commanded	= 0.0;	// Counts, only refreshed on request
+	double	TimeMsec	= 0.0;	// Host time the position was latched, taken as the midpoint of its round trip
+};
+
+// One cycle of bus traffic for an axis. Everything in it is applied under a single take of the
+// node mutex, so no other thread can interleave with the limit writes and the move start.
+struct NodeTransaction
+{
+	bool			ReadStatus		= false;
+	bool			ReadTelemetry	= false;
+	bool			WithCommanded	= false;
+	bool			ReadVelocity	= true;		// Each telemetry field costs its own round trip
+	bool			ReadTorque		= true;
+	bool			Heartbeat		= false;	// Cheapest possible exchange, keeps the watchdog fed
+
+	// Reads the capture registers when the status shows input A latched, needs ReadStatus
+	bool			ReadCapture		= false;
+	bool			CaptureOnRise	= false;	// From the topology
+
+	// Selects the audit test point first if set, reads the results when the status shows a move finished
+	AuditMode		SelectAudit		= AUDIT_OFF;
+	bool			ReadAudit		= false;
+
+	bool			StartMove		= false;
+	bool			MoveRelative	= false;	// MoveTargetCnts is a distance from the last target
+	int32_t			MoveTargetCnts	= 0;
+
+	// Target in the axis' 64 bit coordinates instead, transact fills in the move its control mode calls for
+	bool			MoveVirtual		= false;
+	int64_t			VirtualTargetCnts = 0;
+	double			VelLimit		= 0.0;	// RPM
+	double			AccLimit		= 0.0;	// RPM per second
+	MoveProfile		Profile;				// Shape of the move, only Advanced nodes run more than the trapezoid
+	bool			QueryDuration	= false;	// Ask the drive how long the move takes before starting it
+	bool			Triggered		= false;	// Load the move and wait for triggerGroup, Advanced nodes only
+	int32_t			TriggerGroup	= 0;		// Assign the node to this trigger group first, 0 leaves it
+
+	// Filled in by transact, the telemetry and status are read before the move is started.
+	// Positions read back are in the axis' own coordinates, whatever was folded out of the drive added back
+	int				Result			= 0;
+	StatusSnapshot	Status;
+	TelemetrySample	Telemetry;
+	double			MoveStartMsec	= 0.0;	// Host time around the move start
+	double			MoveSentMsec	= 0.0;
+	double			DriveDurationMsec = 0.0;
+	double			JerkDelayMsec	= -1.0;	// Read back when a new jerk limit was written, negative otherwise
+	bool			WatchdogTripped	= false;	// The node had stopped on its network watchdog, the stop was cleared first
+	bool			Captured		= false;
+	double			CapturedPos		= 0.0;	// Counts, at sample rate
+	double			CapturedHiResPos = 0.0;	// High-speed capture, counts
+	bool			Audited			= false;
+	AuditRecord		Audit;
+};
+
+// Where an axis stands in its own coordinates, which an unbounded axis keeps beyond the drive's 32 bit counter
+struct VirtualAxis
+{
+	uint32_t		SerialNumber	= 0;
+	int64_t			OffsetCnts		= 0;	// Folded out of the drive's position, added back to everything read
+	int64_t			TargetCnts		= 0;	// Last target the drive took
+	bool			TargetValid		= false;
+};
+
+// Move registers as last written to a node, so a move only pays for the settings that changed.
+// NAN is never equal to anything, it marks a register that has to be written before it is trusted.
+struct MoveRegisters
+{
+	double			VelLimit			= NAN;
+	double			AccLimit			= NAN;
+	double			JerkLimit			= NAN;
+	double			DecLimit			= NAN;
+	double			HeadCnts			= NAN;
+	double			TailCnts			= NAN;
+	double			HeadTailVelLimit	= NAN;
+};
+
+// Thermal state of every axis, published as a whole by the supervisor thread
+struct ThermalReport
+{
+	uint32_t		Sequence	= 0;
+	ThermalState	Axis[MN_API_MAX_NODES];
+};
 
 enum Status
 {
@@ -21,30 +129,158 @@ class SCHubController
 {
 private:
 	bool _status = true;
+	std::atomic<bool> _portOpened{ false };
 	SysManager* _myMgr = nullptr;
 	const size_t _portID = 0;
-	
+
+	// Every failure on the bus ends up here instead of being thrown to the caller
+	EventQueue& _events;
+
+	// Node table read by the cook, rebuilt and swapped in whole by the supervisor thread
+	std::shared_ptr<const NodeTopology> _topology;
+	bool _topologyStale = false;		// The last rebuild failed, the supervisor tries again on its next poll
+
+	std::thread _supervisor;
+	std::atomic<bool> _supervising{ false };
+	std::atomic<bool> _attnPending{ false };
+	std::mutex _supervisorMutex;
+	std::condition_variable _supervisorWake;
+
+	// Path and name start of every file the controller keeps, set once by start
+	std::string _statePrefix;
+	bool _started = false;
+
+	// Per-serial axis mapping and settings; only touched by whoever rebuilds the topology
+	NodeProfileStore _profiles{ "" };
+	bool _profilesDirty = false;
+
+	// Homing state carried across restarts; only touched before the supervisor starts, by it, and after it stops
+	WarmStartCache _warmStartCache{ "" };
+	bool _warmStarted[MN_API_MAX_NODES] = {};
+	double _warmStartSavedMsec = 0.0;
+
+	// Low priority sampling on the supervisor thread, published like the topology
+	std::atomic<bool> _thermalMonitoring{ false };
+	std::shared_ptr<const ThermalReport> _thermal;
+	ThermalState _thermalState[MN_API_MAX_NODES];
+	uint32_t _thermalSerial[MN_API_MAX_NODES] = {};
+	double _thermalSampledMsec = 0.0;
+
+	// Applied to every node at connect and again by the supervisor when it changes
+	std::atomic<double> _netWatchdogMsec{ NET_WATCHDOG_MSEC };
+	std::atomic<bool> _netWatchdogChanged{ false };
+
+	// Fed by transactAll, so it measures the loop that actually talks to the bus
+	HeartbeatStats _heartbeat[MN_API_MAX_NODES];
+	uint32_t _heartbeatSerial[MN_API_MAX_NODES] = {};
+
+	// Held by everything that talks to nodes from the cook or the supervisor, and by reconnect while it closes the port
+	std::mutex _transactMutex;
+	std::atomic<double> _lastTransactMsec{ 0.0 };
+	std::atomic<bool> _keepAlive{ false };
+
+	// Bumped whenever a node's real-time status differs from the previous read
+	uint32_t _lastStatusRT[MN_API_MAX_NODES] = {};
+	std::atomic<uint32_t> _statusChanges{ 0 };
+
+	// Runtime settings and requests from the parameter page, picked up by the supervisor
+	std::atomic<double> _topologyPollMsec{ TOPOLOGY_POLL_MSEC };
+	std::atomic<double> _timeoutMsec{ DEFAULT_TIME_TILL_TIMEOUT };
+	std::atomic<bool> _homeRequested{ false };
+	std::atomic<bool> _reconnectRequested{ false };
+	std::atomic<bool> _homing{ false };
+	std::atomic<int> _homingAxis{ -1 };		// Axis homeMotors is working on, transactions leave it alone meanwhile
+	std::atomic<int> _controlModeRequest[MN_API_MAX_NODES];
+	std::atomic<bool> _controlModeChanged{ false };
+
+	// Only touched by runTransaction under the node mutex, anything else that upsets the drive leaves VIRTUAL_LOST_ bits
+	VirtualAxis _virtual[MN_API_MAX_NODES];
+	MoveRegisters _written[MN_API_MAX_NODES];
+	std::atomic<uint32_t> _virtualLost[MN_API_MAX_NODES];
+
+	// sFoundation attention callbacks carry no context
+	static std::atomic<SCHubController*> _attnTarget;
+
 	// For now limit to only support single port, the lowest port on device manager, this enable up to 16 motors
 	int initializePort();
 
-	int homeMotor(INode& theNode);
-	void homeMotors();
+	int homeMotor(size_t iNode, bool warmStart = false);
+	void homeMotors(bool allowWarmStart = true);
+	void reconnect();
+	void applyControlModes();
+
+	bool canWarmStart(INode& theNode);
+	void recordHoming(INode& theNode);
+	void saveWarmStartCache();
+
+	void sampleThermal();
+	void keepAlive();
+	double supervisorPollMsec();
+	void applyNetWatchdog(INode& theNode, double watchdogMsec);
+	void armNetWatchdogs();
+
+	void rebuildTopology();
+	void assignAxes(IPort& myPort, Uint16 nodeCount, Uint16 axisNode[], NodeProfile* axisProfile[]);
+	void applyProfile(size_t iAxis, INode& theNode, NodeProfile& profile);
+	INode& axisNode(size_t iAxis);
+	std::unique_lock<std::mutex> lockOpenPort();		// Owns nothing once the port is closed
+	int runTransaction(size_t iAxis, INode& theNode, const NodeTopology& topology, NodeTransaction& transaction);
+	VirtualAxis& virtualAxis(size_t iAxis, const NodeTopology& topology);
+	void resolveVirtualMove(size_t iAxis, INode& theNode, const NodeTopology& topology, NodeTransaction& transaction);
+	void writeMoveRegisters(size_t iAxis, INode& theNode, NodeTransaction& transaction);
+	void readLimits(INode& theNode, NodeLimits& limits);
+	void rereadLimits();
+	void superviseTopology();
+	static void nodeCallback onAttention(const mnAttnReqReg& detected);
+
+	void reportError(int32_t iNode, EventOp op, const mnErr& theErr);
+	void reportError(int32_t iNode, EventOp op, uint32_t errorCode, const char* message);
 
 public:
-	SCHubController();
+	SCHubController(EventQueue& events);
 	~SCHubController();
 
-	void	enableMotor(size_t iNode, bool newState);
-	bool	enableMotor(size_t iNode);
-	
+	// Loads the state files named statePrefix + suffix, opens the port, homes and starts supervising.
+	// Only the first call does anything.
+	void	start(const std::string& statePrefix);
+	bool	isStarted() const { return _started; }
+
+	int		enableMotor(size_t iNode, bool newState);
+	int		getEnableReq(size_t iNode, bool& isEnabled);
+
+	// Target in the axis' own coordinates, sent as an absolute or relative move depending on its control mode
 	int		rotateMotor(
-				size_t iNode, 
-				int32_t distanceCnts, double velLimi=DEFAULT_VEL_LIM_RPM, double accLimit=DEFAULT_ACC_LIM_RPM_PER_SEC);
+				size_t iNode,
+				int64_t targetCnts, double velLimit=DEFAULT_VEL_LIM_RPM, double accLimit=DEFAULT_ACC_LIM_RPM_PER_SEC);
 
-	double getMeasuredPos(size_t iNode);
-	double getMeasuredVel(size_t iNode);
-	double getMeasuredTrq(size_t iNode);
+	int		readTelemetry(size_t iNode, TelemetrySample& sample, bool withCommanded = false);
+	int		readStatus(size_t iNode, StatusSnapshot& snapshot);
 
-	Uint16 getNodeCount();
-};
+	int		transact(size_t iNode, NodeTransaction& transaction);
+	void	transactAll(NodeTransaction* transactions, size_t count);	// transactions[i] is axis i
+	int		triggerGroup(size_t groupNumber);
 
+	bool	wasWarmStarted(size_t iNode);
+
+	void	setNetWatchdog(double watchdogMsec);
+	HeartbeatStats getHeartbeat(size_t iNode);
+
+	// Heartbeats from the supervisor while the cook is quiet; an armed watchdog gets them regardless
+	void	setKeepAlive(bool enabled);
+	void	setSupervisorPoll(double pollMsec);
+	void	setHomingTimeout(double timeoutMsec);
+	void	setControlMode(size_t iNode, AxisControlMode mode);
+
+	void	requestHoming();
+	void	requestReconnect();
+	bool	isHoming();
+	void	stopAll();
+	uint32_t getStatusChanges();
+
+	void	setThermalMonitoring(bool enabled);
+	std::shared_ptr<const ThermalReport> getThermal();
+
+	std::shared_ptr<const NodeTopology> getTopology();
+	Uint16	getNodeCount();
+	double	timeStampMsec();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+// Raw copy of the node status registers taken in one refresh cycle. Only the lower 32 bits
+// (the attention-capable part) are kept, which hold every field decoded below.
+struct StatusSnapshot
+{
+	uint32_t	RT		= 0;	// Real-time state
+	uint32_t	Rise	= 0;	// Fields asserted since the previous cycle
+	uint32_t	Fall	= 0;	// Fields deasserted since the previous cycle
+	uint32_t	Accum	= 0;	// Fields seen asserted at any time since the previous cycle
+};
+
+// Status fields tracked per node, in packed bit order
+enum StatusField
+{
+	STATUS_ENABLED = 0,
+	STATUS_READY,
+	STATUS_NOT_READY,
+	STATUS_MOVE_DONE,
+	STATUS_ALERT,
+	STATUS_WARNING,
+	STATUS_WAS_HOMED,
+	STATUS_IN_A,
+	STATUS_FIELD_COUNT
+};
+
+// Bit position of each StatusField in cpmStatusRegFlds
+static const uint32_t statusFieldShift[STATUS_FIELD_COUNT] =
+{
+	15,		// Enabled
+	4,		// Ready
+	2,		// NotReady
+	17,		// MoveDone
+	6,		// AlertPresent
+	0,		// Warning
+	11,		// WasHomed
+	22		// InA
+};
+
+inline uint32_t packStatusFields(uint32_t reg)
+{
+	uint32_t packed = 0;
+
+	for (uint32_t k = 0; k < STATUS_FIELD_COUNT; k++)
+		packed |= ((reg >> statusFieldShift[k]) & 1u) << k;
+
+	return packed;
+}
+
+// Decoded status of one node, updated once per cycle without branching on the fields
+struct NodeStatus
+{
+	uint32_t	State	= 0;	// Packed RT fields
+	uint32_t	Seen	= 0;	// Packed Accum fields
+	uint32_t	RiseCount[STATUS_FIELD_COUNT]	= {};
+	uint32_t	FallCount[STATUS_FIELD_COUNT]	= {};
+
+	void update(const StatusSnapshot& snapshot)
+	{
+		uint32_t rise = packStatusFields(snapshot.Rise);
+		uint32_t fall = packStatusFields(snapshot.Fall);
+
+		State = packStatusFields(snapshot.RT);
+		Seen = packStatusFields(snapshot.Accum);
+
+		for (uint32_t k = 0; k < STATUS_FIELD_COUNT; k++)
+		{
+			RiseCount[k] += (rise >> k) & 1u;
+			FallCount[k] += (fall >> k) & 1u;
+		}
+	}
+
+	bool is(StatusField field) const
+	{
+		return ((State >> field) & 1u) != 0;
+	}
+};
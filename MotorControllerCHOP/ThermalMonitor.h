@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#define THERMAL_POLL_MSEC			1000
+#define THERMAL_RMS_TAU_SEC			60.0	// RMS filter time constant assumed for the drive
+#define THERMAL_RMS_LIMIT_PCT		100.0	// RMSlevel at which the drive shuts down
+#define THERMAL_TREND_FILTER		0.2		// Weight of each new steady state estimate
+#define THERMAL_NO_LIMIT			-1.0	// Time to limit when the current duty cycle never reaches it
+#define THERMAL_DERATE_HORIZON_SEC	120.0	// Start derating acceleration this long before the limit
+#define THERMAL_DERATE_MIN			0.25
+
+// First-order model of the drive's RMS level. The level relaxes exponentially towards the
+// value the current duty cycle would settle at, which is recovered from consecutive samples
+// and used to predict when the limit will be crossed.
+struct ThermalState
+{
+	bool		Valid				= false;
+	double		SampleMsec			= 0.0;
+	double		RmsLevelPct			= 0.0;
+	double		SteadyStatePct		= 0.0;
+	double		TimeToLimitSec		= THERMAL_NO_LIMIT;
+	uint32_t	TorqueSaturations	= 0;
+	bool		PowerFault			= false;	// Bus loss, under voltage or wiring error
+
+	void update(double timeMsec, double levelPct)
+	{
+		if (Valid && timeMsec > SampleMsec)
+		{
+			double decay = std::exp(-(timeMsec - SampleMsec) / 1000.0 / THERMAL_RMS_TAU_SEC);
+			double steadyState = (levelPct - RmsLevelPct * decay) / (1.0 - decay);
+
+			SteadyStatePct += THERMAL_TREND_FILTER * (steadyState - SteadyStatePct);
+		}
+		else
+		{
+			SteadyStatePct = levelPct;
+		}
+
+		RmsLevelPct = levelPct;
+		SampleMsec = timeMsec;
+		Valid = true;
+
+		if (RmsLevelPct >= THERMAL_RMS_LIMIT_PCT)
+			TimeToLimitSec = 0.0;
+		else if (SteadyStatePct <= THERMAL_RMS_LIMIT_PCT)
+			TimeToLimitSec = THERMAL_NO_LIMIT;
+		else
+			TimeToLimitSec = THERMAL_RMS_TAU_SEC * std::log((SteadyStatePct - RmsLevelPct) / (SteadyStatePct - THERMAL_RMS_LIMIT_PCT));
+	}
+
+	// Acceleration scale that trades throughput for staying below the limit
+	double derating() const
+	{
+		if (!Valid || TimeToLimitSec < 0.0 || TimeToLimitSec >= THERMAL_DERATE_HORIZON_SEC)
+			return 1.0;
+
+		double scale = TimeToLimitSec / THERMAL_DERATE_HORIZON_SEC;
+
+		return scale > THERMAL_DERATE_MIN ? scale : THERMAL_DERATE_MIN;
+	}
+};
@@ -0,0 +1,74 @@
+#include "WarmStartCache.h"
+
+#include <fstream>
+
+WarmStartCache::WarmStartCache(const char* path) : _path(path)
+{
+}
+
+bool WarmStartCache::load()
+{
+	std::ifstream file(_path);
+
+	if (!file)
+		return false;
+
+	_entries.clear();
+
+	WarmStartEntry entry;
+
+	while (file >> entry.SerialNumber >> entry.Token >> entry.Position)
+		_entries.push_back(entry);
+
+	return true;
+}
+
+bool WarmStartCache::save() const
+{
+	std::ofstream file(_path, std::ios::trunc);
+
+	if (!file)
+		return false;
+
+	file.precision(17);
+
+	for (const WarmStartEntry& entry : _entries)
+		file << entry.SerialNumber << " " << entry.Token << " " << entry.Position << "\n";
+
+	return (bool)file;
+}
+
+const WarmStartEntry* WarmStartCache::find(uint32_t serialNumber) const
+{
+	for (const WarmStartEntry& entry : _entries)
+	{
+		if (entry.SerialNumber == serialNumber)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+void WarmStartCache::update(uint32_t serialNumber, uint32_t token, double position)
+{
+	for (WarmStartEntry& entry : _entries)
+	{
+		if (entry.SerialNumber == serialNumber)
+		{
+			entry.Token = token;
+			entry.Position = position;
+			return;
+		}
+	}
+
+	_entries.push_back({ serialNumber, token, position });
+}
+
+void WarmStartCache::updatePosition(uint32_t serialNumber, double position)
+{
+	for (WarmStartEntry& entry : _entries)
+	{
+		if (entry.SerialNumber == serialNumber)
+			entry.Position = position;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define WARM_START_CACHE_SUFFIX			".warmstart"	// Appended to the controller's state file prefix
+#define WARM_START_USER_DATA_BANK		3		// Info.UserData bank holding the homing token
+#define WARM_START_POS_TOLERANCE_CNTS	100.0	// Allowed drift between the cached and the current position
+#define WARM_START_SAVE_MSEC			5000
+
+struct WarmStartEntry
+{
+	uint32_t	SerialNumber	= 0;
+	uint32_t	Token			= 0;	// Also written to the node, ties the entry to one homing
+	double		Position		= 0.0;	// Last known measured position
+};
+
+// Homing state of every node ever seen, keyed by Info.SerialNumber and kept in a local file
+class WarmStartCache
+{
+private:
+	std::string _path;
+	std::vector<WarmStartEntry> _entries;
+
+public:
+	WarmStartCache(const char* path);
+
+	void setPath(const std::string& path) { _path = path; }
+
+	bool load();
+	bool save() const;
+
+	const WarmStartEntry* find(uint32_t serialNumber) const;
+	void update(uint32_t serialNumber, uint32_t token, double position);
+	void updatePosition(uint32_t serialNumber, double position);
+};
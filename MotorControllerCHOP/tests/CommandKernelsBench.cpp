@@ -0,0 +1,272 @@
+// Times one frame of the command stages over synthetic rigs, outside TouchDesigner, against the
+// per-node path they replaced. Build it optimized, the numbers mean nothing otherwise:
+//   g++ -std=c++17 -O2 -I.. CommandKernelsBench.cpp ../CommandKernels.cpp -o CommandKernelsBench && ./CommandKernelsBench
+#include "CommandKernels.h"
+#include "MotionAuditLog.h"
+#include "MoveDurationModel.h"
+#include "NetWatchdog.h"
+#include "NodeProfiles.h"
+#include "StatusSnapshot.h"
+#include "ThermalMonitor.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define BENCH_FRAMES	2000
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		return EXIT_FAILURE; \
+	}
+
+// MotorInfo as it was before the command fields moved into columns, the whole node state per axis
+struct LegacyMotorInfo
+{
+	double	CmpPos		= 0.0;
+	double	CmdVel		= 0.0;
+	double	CmdAcc		= 0.0;
+	bool	CommandChanged = false;
+	bool	HasCommand	= false;
+	double	PrevCmpPos	= 0.0;
+
+	double	GapOffsetCnts		= 0.0;
+	double	GapStepCnts			= 0.0;
+	double	GapVelLimitRpm		= 0.0;
+
+	double	FilteredPos			= 0.0;
+	uint32_t SuppressedCount	= 0;
+
+	double	TargetPos	= 0.0;
+	double	TargetVel	= 0.0;
+	double	TargetAcc	= 0.0;
+	bool	TargetValid	= false;
+	uint32_t ClampCount	= 0;
+
+	int32_t	SentPos		= 0;
+	double	SentVel		= 0.0;
+	double	SentAcc		= 0.0;
+	bool	SentValid	= false;
+
+	MoveDurationModel Duration;
+	double	PredictedDurationMsec	= 0.0;
+	double	ArrivalMsec				= 0.0;
+	uint32_t PendingMoves			= 0;
+
+	int32_t	Group				= 0;
+	int32_t	DriveTriggerGroup	= 0;
+	double	GroupDurationMsec	= 0.0;
+
+	bool	IsEnable	= false;
+	double	MeasuredPos = 0.0;
+	double	MeasuredVel = 0.0;
+	double	MeasuredTrq = 0.0;
+	double	CommandedPos = 0.0;
+
+	double	MeasuredTimeMsec	= 0.0;
+	double	SampleAgeMsec		= 0.0;
+	double	CompensatedPos		= 0.0;
+	double	CountsPerRev		= 6400.0;
+	double	CountsPerUnit		= 1.0;
+	AxisControlMode ControlMode	= CONTROL_ABSOLUTE;
+
+	NodeStatus StatusFlags;
+
+	bool	CaptureOnRise		= false;
+	double	CapturedPos			= 0.0;
+	double	CapturedHiResPos	= 0.0;
+	double	CaptureTimeMsec		= 0.0;
+	uint32_t CaptureCount		= 0;
+
+	bool	IsAdvanced			= false;
+	AuditMode AuditSelected		= AUDIT_OFF;
+	MotionAuditLog Audit;
+
+	HeartbeatStats Heartbeat;
+
+	ThermalState Thermal;
+	double	AccDerate	= 1.0;
+
+	bool	WarmStarted	= false;
+
+	uint32_t ErrorCount	= 0;
+};
+
+struct BenchResult
+{
+	double		KernelUsec		= 0.0;
+	double		LegacyUsec		= 0.0;
+	uint32_t	KernelMoves		= 0;
+	uint32_t	LegacyMoves		= 0;
+	uint32_t	KernelClamped	= 0;
+	uint32_t	LegacyClamped	= 0;
+};
+
+static double elapsedUsec(std::chrono::steady_clock::time_point start, size_t frames)
+{
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / (double)frames;
+}
+
+// Every frame moves half of the axes, so both paths see a realistic mix of sends and holds
+static double inputPos(size_t axis, size_t frame)
+{
+	return (double)(axis & 1) * (double)(frame & 1) + 0.25 * (double)axis;
+}
+
+static void benchKernels(size_t axes, const NodeLimits& limits, BenchResult& result)
+{
+	MotorCommands commands(axes);
+
+	for (size_t i = 0; i < axes; i++)
+	{
+		commands.setLimits(i, limits);
+		commands.CmdVel[i] = 500.0 + (double)i;
+		commands.CmdAcc[i] = 20000.0;
+		commands.CountsPerUnit[i] = 6400.0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t frame = 0; frame < BENCH_FRAMES; frame++)
+	{
+		for (size_t i = 0; i < axes; i++)
+		{
+			commands.InputPos[i] = inputPos(i, frame);
+			commands.HasCommand[i] = 1;
+		}
+
+		convertCommands(commands, axes);
+
+		// Stands in for the command filter, which both paths share
+		for (size_t i = 0; i < axes; i++)
+		{
+			commands.RawPos[i] = commands.CmpPos[i];
+			commands.FilteredPos[i] = std::round(commands.RawPos[i]);
+		}
+
+		result.KernelClamped += clampCommands(commands, axes);
+		diffPositions(commands, axes, 0.0);
+		diffCommands(commands, axes);
+
+		for (size_t i = 0; i < axes; i++)
+		{
+			if (!commands.Changed[i])
+				continue;
+
+			commands.SentPos[i] = std::round(commands.TargetPos[i]);
+			commands.SentVel[i] = commands.TargetVel[i];
+			commands.SentAcc[i] = commands.TargetAcc[i];
+			commands.SentValid[i] = 1;
+			result.KernelMoves++;
+		}
+	}
+
+	result.KernelUsec = elapsedUsec(start, BENCH_FRAMES);
+}
+
+// setMotorCommand, the clamp loop, positionChanged and the send decision as they were per node
+static void benchLegacy(size_t axes, const NodeLimits& limits, BenchResult& result)
+{
+	std::vector<LegacyMotorInfo> motorsInfo(axes);
+	std::vector<NodeLimits> nodeLimits(axes, limits);
+
+	for (size_t i = 0; i < axes; i++)
+		motorsInfo[i].CountsPerUnit = 6400.0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t frame = 0; frame < BENCH_FRAMES; frame++)
+	{
+		for (size_t i = 0; i < axes; i++)
+		{
+			LegacyMotorInfo& info = motorsInfo[i];
+
+			double cmpPos = inputPos(i, frame) * info.CountsPerUnit;
+
+			info.CommandChanged = cmpPos != info.CmpPos;
+			info.HasCommand = true;
+			info.PrevCmpPos = info.CmpPos;
+
+			info.CmpPos = cmpPos;
+			info.CmdVel = 500.0 + (double)i;
+			info.CmdAcc = 20000.0;
+			info.GapVelLimitRpm = 0.0;
+		}
+
+		for (size_t i = 0; i < axes; i++)
+			motorsInfo[i].FilteredPos = std::round(motorsInfo[i].CmpPos - motorsInfo[i].GapOffsetCnts);
+
+		for (size_t i = 0; i < axes; i++)
+		{
+			LegacyMotorInfo& info = motorsInfo[i];
+
+			info.TargetPos = info.FilteredPos;
+			info.TargetVel = info.GapVelLimitRpm > 0.0 && info.GapVelLimitRpm < info.CmdVel ? info.GapVelLimitRpm : info.CmdVel;
+			info.TargetAcc = info.CmdAcc * info.AccDerate;
+
+			uint32_t clamped = clampCommand(nodeLimits[i], info.TargetPos, info.TargetVel, info.TargetAcc);
+
+			info.TargetValid = (clamped & CLAMP_REJECT) == 0;
+
+			if (clamped != CLAMP_NONE)
+			{
+				info.ClampCount++;
+				result.LegacyClamped++;
+			}
+		}
+
+		for (size_t i = 0; i < axes; i++)
+		{
+			LegacyMotorInfo& cmd = motorsInfo[i];
+
+			bool positionChanged = !cmd.SentValid || cmd.SentPos != (int32_t)std::lround(cmd.TargetPos);
+			bool targetChanged = positionChanged || cmd.SentVel != cmd.TargetVel || cmd.SentAcc != cmd.TargetAcc;
+
+			if (!targetChanged && cmd.HasCommand && (int32_t)std::lround(cmd.CmpPos - cmd.GapOffsetCnts) != cmd.SentPos)
+				cmd.SuppressedCount++;
+
+			if (!cmd.HasCommand || !cmd.TargetValid || !targetChanged)
+				continue;
+
+			cmd.SentPos = (int32_t)std::lround(cmd.TargetPos);
+			cmd.SentVel = cmd.TargetVel;
+			cmd.SentAcc = cmd.TargetAcc;
+			cmd.SentValid = true;
+			result.LegacyMoves++;
+		}
+	}
+
+	result.LegacyUsec = elapsedUsec(start, BENCH_FRAMES);
+}
+
+int main()
+{
+	const size_t rigs[] = { 16, 64, 256 };
+
+	NodeLimits limits;
+	limits.Valid = true;
+	limits.MaxVelRpm = 300.0;
+
+	printf("%8s %14s %14s\n", "axes", "kernels (us)", "per node (us)");
+
+	for (size_t axes : rigs)
+	{
+		BenchResult result;
+
+		benchKernels(axes, limits, result);
+		benchLegacy(axes, limits, result);
+
+		// Both paths must make the same decisions for the timing to compare anything
+		CHECK(result.KernelMoves == result.LegacyMoves);
+		CHECK(result.KernelClamped == result.LegacyClamped);
+
+		printf("%8zu %14.3f %14.3f\n", axes, result.KernelUsec, result.LegacyUsec);
+	}
+
+	return EXIT_SUCCESS;
+}
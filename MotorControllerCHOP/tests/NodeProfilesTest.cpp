@@ -0,0 +1,63 @@
+// Standalone check of the node profile file, outside TouchDesigner:
+//   g++ -std=c++17 -I.. NodeProfilesTest.cpp ../NodeProfiles.cpp -o NodeProfilesTest && ./NodeProfilesTest
+#include "NodeProfiles.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(condition) \
+	if (!(condition)) \
+	{ \
+		fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		return EXIT_FAILURE; \
+	}
+
+int main()
+{
+	const char* path = "NodeProfilesTest.profiles";
+
+	NodeProfileStore saved(path);
+	NodeProfile profile;
+
+	profile.SerialNumber = 123456;
+	profile.UserID = "lift left";
+	profile.Axis = 3;
+	profile.ControlMode = CONTROL_UNBOUNDED;
+	profile.CountsPerUnit = 12800.0 / 3.0;
+	profile.GearRatio = 5.0;
+	profile.UnitsPerRev = 10.0;
+	profile.Direction = -1;
+	profile.MaxVelRpm = 1500.0;
+	profile.ConfigFile = "123456.mtr";
+	profile.ConfigHash = 0xcbf29ce484222325ull;
+
+	saved.add(profile);
+	CHECK(saved.save());
+
+	NodeProfileStore loaded(path);
+
+	CHECK(loaded.findBySerial(profile.SerialNumber) == nullptr);
+	CHECK(loaded.load());
+
+	const NodeProfile* found = loaded.findBySerial(profile.SerialNumber);
+
+	CHECK(found != nullptr);
+	CHECK(found->Axis == profile.Axis);
+	CHECK(found->ControlMode == profile.ControlMode);
+	CHECK(found->CountsPerUnit == profile.CountsPerUnit);
+	CHECK(found->GearRatio == profile.GearRatio);
+	CHECK(found->UnitsPerRev == profile.UnitsPerRev);
+	CHECK(found->Direction == profile.Direction);
+	CHECK(found->MaxVelRpm == profile.MaxVelRpm);
+	CHECK(found->TrqGlobalPct == PROFILE_UNSET);
+	CHECK(found->UserID == profile.UserID);
+	CHECK(found->ConfigFile == profile.ConfigFile);
+	CHECK(found->ConfigHash == profile.ConfigHash);
+	CHECK(loaded.findByUserID("lift left") == found);
+	CHECK(loaded.findBySerial(654321) == nullptr);
+
+	remove(path);
+
+	printf("NodeProfilesTest passed\n");
+	return EXIT_SUCCESS;
+}